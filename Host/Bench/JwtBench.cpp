@@ -0,0 +1,84 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "jwt.h"
+#include "flat_json.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+
+namespace
+{
+	volatile size_t Sink = 0;
+
+	/*same output shape as the DSSLiteBench commandlet, one line per case*/
+	void Run(const char* Name, int Iterations, const std::function<size_t()>& Body)
+	{
+		for (int Index = 0; Index < Iterations / 10; ++Index)
+			Sink += Body();
+
+		const auto Start = std::chrono::steady_clock::now();
+		for (int Index = 0; Index < Iterations; ++Index)
+			Sink += Body();
+		const double Elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+		std::printf("%-28s %10.1f ns/op  %d iterations\n", Name, Elapsed / Iterations, Iterations);
+	}
+
+	template <typename Traits>
+	std::string CreateClientToken()
+	{
+		return jwt::builder<Traits>()
+			.set_payload_claim("name", jwt::basic_claim<Traits>(std::string("BenchPlayer")))
+			.set_payload_claim("role", jwt::basic_claim<Traits>(std::string("client")))
+			.set_expires_at(std::chrono::system_clock::now() + std::chrono::hours{ 1 })
+			.sign(jwt::algorithm::hs256{ "0000000000" });
+	}
+
+	template <typename Traits>
+	size_t DecodeAndVerify(const std::string& Token)
+	{
+		static const auto Verifier = jwt::verifyToken<jwt::default_clock, Traits>(jwt::default_clock{})
+			.allow_algorithm(jwt::algorithm::hs256{ "0000000000" })
+			.with_custom_claim("role", "client");
+		const jwt::decoded_jwt<Traits> Decoded(Token);
+		std::error_code Error;
+		Verifier.verifyToken(Decoded, Error);
+		return Error ? 0 : 1;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	int Iterations = 100000;
+	const char* Filter = nullptr;
+	for (int Index = 1; Index < Argc; ++Index)
+	{
+		if (std::strncmp(Argv[Index], "-Iterations=", 12) == 0)
+			Iterations = std::max(1, std::atoi(Argv[Index] + 12));
+		else if (std::strncmp(Argv[Index], "-Filter=", 8) == 0)
+			Filter = Argv[Index] + 8;
+	}
+	auto Case = [&](const char* Name, const std::function<size_t()>& Body)
+	{
+		if (Filter == nullptr || std::strstr(Name, Filter) != nullptr)
+			Run(Name, Iterations, Body);
+	};
+
+	const std::string Token = CreateClientToken<jwt::flat_json_traits>();
+	const std::string Payload = jwt::base::decode<jwt::alphabet::base64url>(jwt::base::pad<jwt::alphabet::base64url>(Token.substr(Token.find('.') + 1, Token.rfind('.') - Token.find('.') - 1)));
+	const jwt::algorithm::hs256 Hs256{ "0000000000" };
+
+	Case("Base64UrlEncode", [&]() { return jwt::base::encode<jwt::alphabet::base64url>(Payload).size(); });
+	Case("Base64UrlDecode", [&]() { return jwt::base::decode<jwt::alphabet::base64url>(jwt::base::pad<jwt::alphabet::base64url>(Token.substr(0, Token.find('.')))).size(); });
+	Case("Hs256Sign", [&]() { std::error_code Error; return Hs256.sign(Payload, Error).size(); });
+	Case("JsonParsePicojson", [&]() { picojson::value Value; return picojson::parse(Value, Payload).size(); });
+	Case("JsonParseFlatJson", [&]() { jwt::flat_json::value Value; return (size_t)jwt::flat_json_traits::parse(Value, Payload); });
+	Case("CreateTokenPicojson", []() { return CreateClientToken<jwt::picojson_traits>().size(); });
+	Case("CreateTokenFlatJson", []() { return CreateClientToken<jwt::flat_json_traits>().size(); });
+	Case("VerifyTokenPicojson", [&]() { return DecodeAndVerify<jwt::picojson_traits>(Token); });
+	Case("VerifyTokenFlatJson", [&]() { return DecodeAndVerify<jwt::flat_json_traits>(Token); });
+	return 0;
+}
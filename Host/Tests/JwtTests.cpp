@@ -0,0 +1,316 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "jwt.h"
+#include "flat_json.h"
+#include "DSSLiteJwt.h"
+#include "DSSLiteFixedClaimToken.h"
+
+#include <openssl/hmac.h>
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	int Failures = 0;
+
+	#define CHECK(Expr) do { if (!(Expr)) { std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Expr); ++Failures; } } while (0)
+
+	struct FTestCase
+	{
+		const char* Name;
+		std::function<void()> Body;
+	};
+
+	std::vector<FTestCase>& GetTests()
+	{
+		static std::vector<FTestCase> Tests;
+		return Tests;
+	}
+
+	struct FRegisterTest
+	{
+		FRegisterTest(const char* Name, std::function<void()> Body)
+		{
+			GetTests().push_back({ Name, std::move(Body) });
+		}
+	};
+
+	#define HOST_TEST(Name) \
+		static void Name(); \
+		static FRegisterTest Name##Registration(#Name, &Name); \
+		static void Name()
+
+	/*bit by bit reference the table driven codec is compared against*/
+	std::string ReferenceBase64Url(const std::string& Bin)
+	{
+		static const char* Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		std::string Out;
+		uint32_t Buffer = 0;
+		int Bits = 0;
+		for (unsigned char Byte : Bin)
+		{
+			Buffer = (Buffer << 8) | Byte;
+			Bits += 8;
+			while (Bits >= 6)
+			{
+				Bits -= 6;
+				Out.push_back(Alphabet[(Buffer >> Bits) & 0x3F]);
+			}
+		}
+		if (Bits > 0)
+			Out.push_back(Alphabet[(Buffer << (6 - Bits)) & 0x3F]);
+		return Out;
+	}
+
+	std::string Hs256(const std::string& Key, const std::string& Data)
+	{
+		unsigned char Digest[EVP_MAX_MD_SIZE];
+		unsigned int Length = 0;
+		HMAC(EVP_sha256(), Key.data(), (int)Key.size(), (const unsigned char*)Data.data(), Data.size(), Digest, &Length);
+		return std::string((const char*)Digest, Length);
+	}
+
+	template <typename Traits>
+	std::string CreateClientToken(const std::string& Name, const std::string& Key, std::chrono::system_clock::time_point Expiry)
+	{
+		return jwt::builder<Traits>()
+			.set_payload_claim("name", jwt::basic_claim<Traits>(Name))
+			.set_payload_claim("role", jwt::basic_claim<Traits>(std::string("client")))
+			.set_expires_at(Expiry)
+			.sign(jwt::algorithm::hs256{ Key });
+	}
+
+	/*the checks DSSLiteTokens::FClientTokenVerifier runs before caching a token, without the cache*/
+	bool VerifyClientToken(const std::string& Token, const std::string& Key, std::string* OutName = nullptr)
+	{
+		std::string Name;
+		int64_t Exp = 0;
+		std::string Error;
+		const bool bVerified = DSSLiteJwt::VerifyClientToken(DSSLiteJwt::ClientVerifier(Key), Token, Name, Exp, Error);
+		if (OutName != nullptr)
+			*OutName = Name;
+		return bVerified;
+	}
+
+	std::string FixedClientToken(const std::string& Name, const std::string& Key, std::chrono::system_clock::time_point Expiry, bool& bOutSigned)
+	{
+		DSSLiteJwt::FFixedClaimToken Token;
+		Token.AddInteger("exp", (int64_t)std::chrono::system_clock::to_time_t(Expiry));
+		Token.AddString("name", Name.data(), (int)Name.size());
+		Token.AddString("role", "client", 6);
+		const char* Chars = nullptr;
+		int Length = 0;
+		bOutSigned = Token.Sign(jwt::algorithm::hs256{ Key }, Chars, Length);
+		return bOutSigned ? std::string(Chars, Length) : std::string();
+	}
+}
+
+HOST_TEST(Base64UrlMatchesReference)
+{
+	std::mt19937 Random(42);
+	for (size_t Length = 0; Length < 200; ++Length)
+	{
+		std::string Bin(Length, '\0');
+		for (char& Byte : Bin)
+			Byte = (char)(Random() & 0xFF);
+
+		const std::string Encoded = jwt::base::trim<jwt::alphabet::base64url>(jwt::base::encode<jwt::alphabet::base64url>(Bin));
+		CHECK(Encoded == ReferenceBase64Url(Bin));
+		CHECK(jwt::base::decode<jwt::alphabet::base64url>(jwt::base::pad<jwt::alphabet::base64url>(Encoded)) == Bin);
+	}
+}
+
+HOST_TEST(Base64RejectsInvalidInput)
+{
+	bool bThrew = false;
+	try
+	{
+		jwt::base::decode<jwt::alphabet::base64url>("ab*d");
+	}
+	catch (const std::runtime_error&)
+	{
+		bThrew = true;
+	}
+	CHECK(bThrew);
+}
+
+HOST_TEST(FlatJsonMatchesPicojson)
+{
+	const char* Documents[] = {
+		"{}",
+		"{\"b\":1,\"a\":2,\"a\":3}",
+		"{\"x\":1.0}",
+		"{\"x\":-0}",
+		"{\"x\":123456789012345678901}",
+		"{\"x\":\"\\u00e9\\ud83d\\ude00/\\n\"}",
+		"{\"x\":[1,2,{\"z\":null}],\"y\":true,\"w\":false}",
+		" { \"exp\" : 4000000000 , \"name\" : \"player\" } ",
+	};
+	for (const char* Document : Documents)
+	{
+		picojson::value Pico;
+		const std::string PicoError = picojson::parse(Pico, std::string(Document));
+		jwt::flat_json::value Flat;
+		const bool bFlatParsed = jwt::flat_json_traits::parse(Flat, Document);
+		CHECK(PicoError.empty() == bFlatParsed);
+		if (PicoError.empty() && bFlatParsed)
+			CHECK(Pico.serialize() == Flat.serialize());
+	}
+}
+
+HOST_TEST(FlatJsonRejectsMalformedInput)
+{
+	const char* Documents[] = { "", "{", "{\"a\":}", "{\"a\":1,}", "{\"a\":1} x", "{\"a\":\"\\q\"}", "[1,2", "{\"a\":1e400}", "[-1e400]" };
+	for (const char* Document : Documents)
+	{
+		jwt::flat_json::value Flat;
+		CHECK(!jwt::flat_json_traits::parse(Flat, Document));
+	}
+}
+
+HOST_TEST(TokensAreIdenticalAcrossTraits)
+{
+	const auto Expiry = std::chrono::system_clock::time_point(std::chrono::seconds{ 4000000000 });
+	const std::string Pico = CreateClientToken<jwt::picojson_traits>("a/b\x01", "0000000000", Expiry);
+	const std::string Flat = CreateClientToken<jwt::flat_json_traits>("a/b\x01", "0000000000", Expiry);
+	CHECK(Pico == Flat);
+}
+
+HOST_TEST(Hs256SignatureMatchesOneShotHmac)
+{
+	const jwt::algorithm::hs256 Algorithm{ "0000000000" };
+	for (int Index = 0; Index < 64; ++Index)
+	{
+		const std::string Data = "header.payload" + std::to_string(Index);
+		std::error_code Error;
+		CHECK(Algorithm.sign(Data, Error) == Hs256("0000000000", Data));
+		CHECK(!Error);
+	}
+}
+
+HOST_TEST(Hs256IsSafeToShareAcrossThreads)
+{
+	const jwt::algorithm::hs256 Algorithm{ "0000000000" };
+	std::atomic<int> Mismatches{ 0 };
+	std::vector<std::thread> Threads;
+	for (int Thread = 0; Thread < 8; ++Thread)
+	{
+		Threads.emplace_back([&Algorithm, &Mismatches, Thread]()
+			{
+				for (int Index = 0; Index < 500; ++Index)
+				{
+					const std::string Data = "payload" + std::to_string(Index * 8 + Thread);
+					std::error_code Error;
+					const std::string Signature = Algorithm.sign(Data, Error);
+					if (Error || Signature != Hs256("0000000000", Data))
+						++Mismatches;
+					Algorithm.verifyToken(Data, Signature, Error);
+					if (Error)
+						++Mismatches;
+				}
+			});
+	}
+	for (std::thread& Thread : Threads)
+		Thread.join();
+	CHECK(Mismatches == 0);
+}
+
+HOST_TEST(FixedClaimTokenMatchesBuilder)
+{
+	const auto Expiry = std::chrono::system_clock::time_point(std::chrono::seconds{ 1700000000 });
+	const std::string Values[] = {
+		"", "Player42", "0000000000", "quote\"back\\slash/", "tab\tnew\nline\r\b\f",
+		"ctrl\x01\x1f\x7f", "caf\xc3\xa9 \xe4\xb8\x96\xe7\x95\x8c", std::string(200, 'x') };
+	for (const std::string& Value : Values)
+	{
+		for (const std::string& Key : { std::string("0000000000"), Value })
+		{
+			bool bSigned = false;
+			const std::string Fixed = FixedClientToken(Value, Key, Expiry, bSigned);
+			CHECK(bSigned);
+			CHECK(Fixed == CreateClientToken<jwt::flat_json_traits>(Value, Key, Expiry));
+			CHECK(Fixed == CreateClientToken<jwt::picojson_traits>(Value, Key, Expiry));
+
+			DSSLiteJwt::FFixedClaimToken Server;
+			Server.AddInteger("exp", 1700000000);
+			Server.AddString("key", Value.data(), (int)Value.size());
+			Server.AddString("port", "7777", 4);
+			Server.AddString("role", "server", 6);
+			const char* Chars = nullptr;
+			int Length = 0;
+			CHECK(Server.Sign(jwt::algorithm::hs256{ Key }, Chars, Length));
+			const std::string Expected = jwt::builder<jwt::picojson_traits>()
+				.set_payload_claim("port", jwt::basic_claim<jwt::picojson_traits>(std::string("7777")))
+				.set_payload_claim("role", jwt::basic_claim<jwt::picojson_traits>(std::string("server")))
+				.set_payload_claim("key", jwt::basic_claim<jwt::picojson_traits>(Value))
+				.set_expires_at(Expiry)
+				.sign(jwt::algorithm::hs256{ Key });
+			CHECK(std::string(Chars, Length) == Expected);
+		}
+	}
+}
+
+HOST_TEST(FixedClaimTokenRejectsOversizedClaims)
+{
+	bool bSigned = true;
+	FixedClientToken(std::string(1000, 'y'), "0000000000", std::chrono::system_clock::now(), bSigned);
+	CHECK(!bSigned);
+}
+
+HOST_TEST(ClientVerifierAcceptsValidClientTokens)
+{
+	const auto Expiry = std::chrono::system_clock::now() + std::chrono::seconds{ 60 };
+	std::string Name;
+	CHECK(VerifyClientToken(CreateClientToken<jwt::flat_json_traits>("player", "key", Expiry), "key", &Name));
+	CHECK(Name == "player");
+	CHECK(VerifyClientToken(CreateClientToken<jwt::picojson_traits>("caf\xc3\xa9", "k\xc3\xa9y", Expiry), "k\xc3\xa9y", &Name));
+	CHECK(Name == "caf\xc3\xa9");
+}
+
+HOST_TEST(ClientVerifierRejectsBadTokens)
+{
+	const auto Expiry = std::chrono::system_clock::now() + std::chrono::seconds{ 60 };
+	const std::string Token = CreateClientToken<jwt::flat_json_traits>("player", "key", Expiry);
+	CHECK(!VerifyClientToken(Token, "other key"));
+
+	// the last character of a 32 byte signature also carries padding bits, flip the first one
+	std::string Tampered = Token;
+	char& SignatureChar = Tampered[Tampered.rfind('.') + 1];
+	SignatureChar = SignatureChar == 'A' ? 'B' : 'A';
+	CHECK(!VerifyClientToken(Tampered, "key"));
+
+	const std::string Expired = CreateClientToken<jwt::flat_json_traits>("player", "key", std::chrono::system_clock::now() - std::chrono::seconds{ 60 });
+	CHECK(!VerifyClientToken(Expired, "key"));
+
+	const std::string Server = jwt::builder<jwt::flat_json_traits>()
+		.set_payload_claim("role", jwt::basic_claim<jwt::flat_json_traits>(std::string("server")))
+		.set_expires_at(Expiry)
+		.sign(jwt::algorithm::hs256{ "key" });
+	CHECK(!VerifyClientToken(Server, "key"));
+
+	const std::string Nameless = jwt::builder<jwt::flat_json_traits>()
+		.set_payload_claim("role", jwt::basic_claim<jwt::flat_json_traits>(std::string("client")))
+		.set_expires_at(Expiry)
+		.sign(jwt::algorithm::hs256{ "key" });
+	CHECK(!VerifyClientToken(Nameless, "key"));
+
+	CHECK(!VerifyClientToken("not.a.token", "key"));
+}
+
+int main()
+{
+	for (const FTestCase& Test : GetTests())
+	{
+		const int FailuresBefore = Failures;
+		Test.Body();
+		std::printf("[%s] %s\n", Failures == FailuresBefore ? "PASS" : "FAIL", Test.Name);
+	}
+	std::printf("%zu tests, %d failed checks\n", GetTests().size(), Failures);
+	return Failures == 0 ? 0 : 1;
+}
@@ -46,7 +46,8 @@ public class DSSLite : ModuleRules
 				"SlateCore",
 				"HTTP",
 			    "WebSockets",
-				"OpenSSL"
+				"OpenSSL",
+				"AssetRegistry"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,464 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSEmulator.h"
+#include "DSSLiteModule.h"
+#include "DSSLiteTokens.h"
+#include "LoopbackSignalRServer.h"
+#include "ServerState.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "HAL/IConsoleManager.h"
+
+static const TCHAR* ClientsHubPath = TEXT("/ClientsHub");
+static const TCHAR* ServersHubPath = TEXT("/ServersHub");
+
+bool FDSSEmulatorScenario::LoadFromFile(const FString& InFile, FDSSEmulatorScenario& OutScenario)
+{
+	FString Json;
+	if (!FFileHelper::LoadFileToString(Json, *InFile))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Cannot read emulator scenario %s."), *InFile);
+		return false;
+	}
+	return LoadFromString(Json, OutScenario);
+}
+
+bool FDSSEmulatorScenario::LoadFromString(const FString& InJson, FDSSEmulatorScenario& OutScenario)
+{
+	TSharedPtr<FJsonObject> Root;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(InJson), Root) || !Root.IsValid())
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Emulator scenario is not valid JSON."));
+		return false;
+	}
+
+	FDSSEmulatorScenario Scenario;
+	Root->TryGetStringField(TEXT("Name"), Scenario.Name);
+	Root->TryGetNumberField(TEXT("LatencyMs"), Scenario.LatencyMs);
+	Root->TryGetNumberField(TEXT("JitterMs"), Scenario.JitterMs);
+	Root->TryGetNumberField(TEXT("Loss"), Scenario.Loss);
+	Root->TryGetStringField(TEXT("ServerIP"), Scenario.ServerIP);
+	Root->TryGetNumberField(TEXT("DungeonBasePort"), Scenario.DungeonBasePort);
+	Root->TryGetNumberField(TEXT("DungeonSpinUpMs"), Scenario.DungeonSpinUpMs);
+	Root->TryGetStringField(TEXT("SigningKey"), Scenario.SigningKey);
+	Root->TryGetNumberField(TEXT("Clients"), Scenario.Clients);
+	Root->TryGetNumberField(TEXT("TravelsPerClient"), Scenario.TravelsPerClient);
+
+	const TArray<TSharedPtr<FJsonValue>>* Levels;
+	if (Root->TryGetArrayField(TEXT("Levels"), Levels))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Levels)
+		{
+			const TSharedPtr<FJsonObject> Object = Value->AsObject();
+			if (!Object.IsValid())
+				continue;
+
+			FDSSEmulatorLevel Level;
+			Object->TryGetStringField(TEXT("Name"), Level.Name);
+			Object->TryGetNumberField(TEXT("Port"), Level.Port);
+			Object->TryGetNumberField(TEXT("SpinUpMs"), Level.SpinUpMs);
+			Scenario.Levels.Add(Level);
+		}
+	}
+
+	const TSharedPtr<FJsonObject>* Travel;
+	if (Root->TryGetObjectField(TEXT("Travel"), Travel))
+	{
+		(*Travel)->TryGetNumberField(TEXT("Options"), Scenario.TravelOptions);
+		(*Travel)->TryGetStringField(TEXT("Tag"), Scenario.TravelTag);
+		(*Travel)->TryGetNumberField(TEXT("Yaw"), Scenario.TravelYaw);
+		const TArray<TSharedPtr<FJsonValue>>* Location;
+		if ((*Travel)->TryGetArrayField(TEXT("Location"), Location) && Location->Num() == 3)
+		{
+			Scenario.TravelLocation = FVector((*Location)[0]->AsNumber(), (*Location)[1]->AsNumber(), (*Location)[2]->AsNumber());
+		}
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Events;
+	if (Root->TryGetArrayField(TEXT("Events"), Events))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Events)
+		{
+			const TSharedPtr<FJsonObject> Object = Value->AsObject();
+			if (!Object.IsValid())
+				continue;
+
+			FDSSEmulatorEvent Event;
+			Object->TryGetNumberField(TEXT("AtMs"), Event.AtMs);
+			Object->TryGetStringField(TEXT("Type"), Event.Type);
+			Object->TryGetNumberField(TEXT("Port"), Event.Port);
+			Object->TryGetStringField(TEXT("Name"), Event.Name);
+			if (Event.Type != TEXT("ServerClose") && Event.Type != TEXT("PlayerDisconnected") && Event.Type != TEXT("AssignLevel"))
+			{
+				UE_LOG(LogDSSLite, Warning, TEXT("Ignoring emulator event of unknown type '%s'."), *Event.Type);
+				continue;
+			}
+			Scenario.Events.Add(Event);
+		}
+		Scenario.Events.StableSort([](const FDSSEmulatorEvent& A, const FDSSEmulatorEvent& B) { return A.AtMs < B.AtMs; });
+	}
+
+	if (Scenario.Levels.Num() == 0)
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Emulator scenario %s has no levels."), *Scenario.Name);
+		return false;
+	}
+
+	OutScenario = MoveTemp(Scenario);
+	return true;
+}
+
+FDSSEmulator::FDSSEmulator(const FDSSEmulatorScenario& InScenario) :
+	Scenario(InScenario),
+	Server(FLoopbackSignalRServer::Create(InScenario.Name)),
+	NextDungeonPort(InScenario.DungeonBasePort)
+{
+	Server->SetLatency(Scenario.LatencyMs, Scenario.JitterMs);
+	Server->SetLossRate(Scenario.Loss);
+	Server->OnClientHandshake().AddRaw(this, &FDSSEmulator::HandleHandshake);
+	Server->OnClientDisconnected().AddRaw(this, &FDSSEmulator::HandleDisconnected);
+
+	Server->On(TEXT("Travel")).BindRaw(this, &FDSSEmulator::HandleTravel, 0);
+	Server->On(TEXT("TravelWithTag")).BindRaw(this, &FDSSEmulator::HandleTravel, 1);
+	Server->On(TEXT("TravelWithCoordinates")).BindRaw(this, &FDSSEmulator::HandleTravel, 2);
+	Server->On(TEXT("ServerState")).BindRaw(this, &FDSSEmulator::HandleServerState);
+}
+
+FDSSEmulator::~FDSSEmulator()
+{
+	Server->OnClientHandshake().RemoveAll(this);
+	Server->OnClientDisconnected().RemoveAll(this);
+	Server->On(TEXT("Travel")).Unbind();
+	Server->On(TEXT("TravelWithTag")).Unbind();
+	Server->On(TEXT("TravelWithCoordinates")).Unbind();
+	Server->On(TEXT("ServerState")).Unbind();
+}
+
+FString FDSSEmulator::GetUrl() const
+{
+	return FString(FLoopbackSignalRServer::Scheme) + Scenario.Name;
+}
+
+FString FDSSEmulator::GetUrl(const FString& InHubPath) const
+{
+	return Server->GetUrl(InHubPath);
+}
+
+void FDSSEmulator::Start()
+{
+	StartTime = FPlatformTime::Seconds();
+	NextEvent = 0;
+}
+
+void FDSSEmulator::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	if (IsStarted())
+	{
+		while (NextEvent < Scenario.Events.Num() && (Now - StartTime) * 1000.0 >= Scenario.Events[NextEvent].AtMs)
+		{
+			FireEvent(Scenario.Events[NextEvent++]);
+		}
+	}
+
+	// ClientTravel held back by server spin up or a server that is not warm yet
+	for (int32 Index = 0; Index < PendingPushes.Num();)
+	{
+		if (PendingPushes[Index].DueTime > Now || !IsServerReady(PendingPushes[Index].Port))
+		{
+			++Index;
+			continue;
+		}
+		FPendingPush Push = MoveTemp(PendingPushes[Index]);
+		PendingPushes.RemoveAt(Index, 1, false);
+		if (Sessions.Contains(Push.ClientId))
+		{
+			Server->Send(Push.ClientId, TEXT("ClientTravel"), Push.Arguments);
+		}
+	}
+}
+
+TStatId FDSSEmulator::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FDSSEmulator, STATGROUP_Tickables);
+}
+
+void FDSSEmulator::HandleHandshake(int32 InClientId)
+{
+	FString Path;
+	const FString Url = Server->GetClientUrl(InClientId);
+	FLoopbackSignalRServer::FindForUrl(Url, &Path);
+
+	FString Token;
+	int32 QueryPos;
+	if (Url.FindChar(TEXT('?'), QueryPos))
+	{
+		TArray<FString> Pairs;
+		Url.RightChop(QueryPos + 1).ParseIntoArray(Pairs, TEXT("&"));
+		for (const FString& Pair : Pairs)
+		{
+			if (Pair.StartsWith(TEXT("access_token=")))
+			{
+				Token = Pair.RightChop(13);
+			}
+		}
+	}
+
+	FSession Session;
+	if (Path == ServersHubPath)
+	{
+		FString Port;
+		Session.Role = ERole::Server;
+		if (DSSLiteTokens::GetClaim(Token, TEXT("port"), Port))
+		{
+			Session.Port = FCString::Atoi(*Port);
+			RunningPorts.Add(Session.Port);
+		}
+	}
+	else
+	{
+		if (Path != ClientsHubPath)
+		{
+			UE_LOG(LogDSSLite, Warning, TEXT("Emulator client %d connected to unknown hub %s, treating it as a client."), InClientId, *Path);
+		}
+		Session.Role = ERole::Client;
+		if (!DSSLiteTokens::GetClaim(Token, TEXT("name"), Session.PlayerName))
+		{
+			Session.PlayerName = FString::Printf(TEXT("Player%d"), InClientId);
+		}
+	}
+	Sessions.Add(InClientId, Session);
+
+	TArray<FSignalRValue> Arguments;
+	Arguments.Add(FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphens));
+	Arguments.Add(FString::FromInt(InClientId));
+	Arguments.Add(FDateTime::UtcNow().ToString());
+	Server->Send(InClientId, TEXT("OnConnect"), Arguments);
+}
+
+void FDSSEmulator::HandleDisconnected(int32 InClientId)
+{
+	FSession Session;
+	if (!Sessions.RemoveAndCopyValue(InClientId, Session))
+		return;
+
+	if (Session.Role == ERole::Server)
+		return;
+
+	for (const TPair<int32, FSession>& Pair : Sessions)
+	{
+		if (Pair.Value.Role == ERole::Server)
+		{
+			Server->Send(Pair.Key, TEXT("PlayerDisconnected"), { FSignalRValue(Session.PlayerName) });
+		}
+	}
+}
+
+FSignalRValue FDSSEmulator::HandleTravel(int32 InClientId, const TArray<FSignalRValue>& InArguments, int32 InOptions)
+{
+	// MapName, bIsDungeon, InstanceID, then Tag or X, Y, Z, Yaw, then CharacterName when sent by a server
+	const int32 NumOptionArguments = InOptions == 1 ? 1 : InOptions == 2 ? 4 : 0;
+	const FSession* Session = Sessions.Find(InClientId);
+	if (Session == nullptr || InArguments.Num() < 3 + NumOptionArguments)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Emulator received a malformed travel request from client %d."), InClientId);
+		return FSignalRValue();
+	}
+
+	const FString MapName = InArguments[0].AsString();
+	const bool bIsDungeon = InArguments[1].AsBool();
+	const FString InstanceId = InArguments[2].AsString();
+
+	FString PlayerName = Session->PlayerName;
+	int32 TargetClientId = InClientId;
+	if (InArguments.IsValidIndex(3 + NumOptionArguments))
+	{
+		PlayerName = InArguments[3 + NumOptionArguments].AsString();
+		TargetClientId = FindClientByName(PlayerName);
+	}
+	if (Session->Role == ERole::Server && InArguments.Num() == 3 + NumOptionArguments)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Emulator server travel without a character name from client %d."), InClientId);
+		return FSignalRValue();
+	}
+	if (TargetClientId == INDEX_NONE)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Emulator cannot travel %s, the player is not connected."), *PlayerName);
+		return FSignalRValue();
+	}
+
+	float SpinUpMs = 0.f;
+	const int32 Port = ResolvePort(MapName, bIsDungeon, InstanceId, SpinUpMs);
+	if (Port == 0)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Emulator has no level named %s."), *MapName);
+		return FSignalRValue();
+	}
+
+	const int32 ServerClientId = FindServerByPort(Port);
+
+	FPendingPush Push;
+	Push.DueTime = FPlatformTime::Seconds() + SpinUpMs / 1000.0;
+	Push.ClientId = TargetClientId;
+	Push.Port = Port;
+	Push.Arguments.Add(Scenario.ServerIP);
+	Push.Arguments.Add(Port);
+	Push.Arguments.Add(PlayerName);
+	Push.Arguments.Add(ServerClientId != INDEX_NONE ? FString::FromInt(ServerClientId) : FString());
+	Push.Arguments.Add(InOptions);
+	for (int32 Index = 0; Index < NumOptionArguments; ++Index)
+	{
+		Push.Arguments.Add(InArguments[3 + Index]);
+	}
+
+	++NumTravels;
+	if (SpinUpMs <= 0.f && IsServerReady(Port))
+	{
+		Server->Send(Push.ClientId, TEXT("ClientTravel"), Push.Arguments);
+	}
+	else
+	{
+		PendingPushes.Add(MoveTemp(Push));
+	}
+	return FSignalRValue();
+}
+
+FSignalRValue FDSSEmulator::HandleServerState(int32 InClientId, const TArray<FSignalRValue>& InArguments)
+{
+	FSession* Session = Sessions.Find(InClientId);
+	if (Session == nullptr || Session->Role != ERole::Server || InArguments.Num() < 1)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Emulator received a malformed ServerState from client %d."), InClientId);
+		return FSignalRValue();
+	}
+	Session->State = InArguments[0].AsInt();
+	UE_LOG(LogDSSLite, Display, TEXT("Emulator server at port %d is %s."), Session->Port, *StaticEnum<EDSSServerState>()->GetNameStringByValue(Session->State));
+	return FSignalRValue();
+}
+
+void FDSSEmulator::FireEvent(const FDSSEmulatorEvent& InEvent)
+{
+	UE_LOG(LogDSSLite, Display, TEXT("Emulator event %s at %.0f ms."), *InEvent.Type, InEvent.AtMs);
+
+	if (InEvent.Type == TEXT("ServerClose"))
+	{
+		for (const TPair<int32, FSession>& Pair : Sessions)
+		{
+			if (Pair.Value.Role == ERole::Server && (InEvent.Port == 0 || Pair.Value.Port == InEvent.Port))
+			{
+				Server->Send(Pair.Key, TEXT("ServerClose"));
+			}
+		}
+		if (InEvent.Port == 0)
+		{
+			RunningPorts.Reset();
+		}
+		else
+		{
+			RunningPorts.Remove(InEvent.Port);
+		}
+	}
+	else if (InEvent.Type == TEXT("AssignLevel"))
+	{
+		for (const TPair<int32, FSession>& Pair : Sessions)
+		{
+			if (Pair.Value.Role == ERole::Server && (InEvent.Port == 0 || Pair.Value.Port == InEvent.Port))
+			{
+				Server->Send(Pair.Key, TEXT("AssignLevel"), { FSignalRValue(InEvent.Name) });
+			}
+		}
+	}
+	else if (InEvent.Type == TEXT("PlayerDisconnected"))
+	{
+		for (const TPair<int32, FSession>& Pair : Sessions)
+		{
+			if (Pair.Value.Role == ERole::Server)
+			{
+				Server->Send(Pair.Key, TEXT("PlayerDisconnected"), { FSignalRValue(InEvent.Name) });
+			}
+		}
+	}
+}
+
+int32 FDSSEmulator::ResolvePort(const FString& InMapName, bool bIsDungeon, const FString& InInstanceId, float& OutSpinUpMs)
+{
+	const FDSSEmulatorLevel* Level = Scenario.Levels.FindByPredicate([&InMapName](const FDSSEmulatorLevel& Candidate) { return Candidate.Name == InMapName; });
+	if (Level == nullptr)
+		return 0;
+
+	int32 Port = Level->Port;
+	float SpinUpMs = Level->SpinUpMs;
+	if (bIsDungeon)
+	{
+		// every instance gets its own server
+		int32& DungeonPort = DungeonPorts.FindOrAdd(InMapName + TEXT("#") + InInstanceId, 0);
+		if (DungeonPort == 0)
+		{
+			DungeonPort = NextDungeonPort++;
+		}
+		Port = DungeonPort;
+		SpinUpMs = Scenario.DungeonSpinUpMs;
+	}
+
+	bool bAlreadyRunning = false;
+	RunningPorts.Add(Port, &bAlreadyRunning);
+	OutSpinUpMs = bAlreadyRunning ? 0.f : SpinUpMs;
+	return Port;
+}
+
+int32 FDSSEmulator::FindClientByName(const FString& InPlayerName) const
+{
+	for (const TPair<int32, FSession>& Pair : Sessions)
+	{
+		if (Pair.Value.Role == ERole::Client && Pair.Value.PlayerName == InPlayerName)
+			return Pair.Key;
+	}
+	return INDEX_NONE;
+}
+
+int32 FDSSEmulator::FindServerByPort(int32 InPort) const
+{
+	for (const TPair<int32, FSession>& Pair : Sessions)
+	{
+		if (Pair.Value.Role == ERole::Server && Pair.Value.Port == InPort)
+			return Pair.Key;
+	}
+	return INDEX_NONE;
+}
+
+bool FDSSEmulator::IsServerReady(int32 InPort) const
+{
+	// servers that never report a state are taken as ready, like before ServerState existed
+	const int32 ServerClientId = FindServerByPort(InPort);
+	return ServerClientId == INDEX_NONE || Sessions[ServerClientId].State == INDEX_NONE || Sessions[ServerClientId].State == (int32)EDSSServerState::Warm;
+}
+
+static TSharedPtr<FDSSEmulator> ConsoleEmulator;
+
+static FAutoConsoleCommand EmulatorCommand(
+	TEXT("DSSLite.Emulator"),
+	TEXT("DSSLite.Emulator <Scenario.json>|stop: runs a DSS emulator, connect to loopback://<ScenarioName>."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() == 0)
+			{
+				UE_LOG(LogDSSLite, Display, TEXT("Usage: DSSLite.Emulator <Scenario.json>|stop"));
+				return;
+			}
+
+			ConsoleEmulator.Reset();
+			if (Args[0] == TEXT("stop"))
+				return;
+
+			FDSSEmulatorScenario Scenario;
+			if (!FDSSEmulatorScenario::LoadFromFile(Args[0], Scenario))
+				return;
+
+			ConsoleEmulator = MakeShared<FDSSEmulator>(Scenario);
+			ConsoleEmulator->Start();
+			UE_LOG(LogDSSLite, Display, TEXT("DSS emulator running at %s."), *ConsoleEmulator->GetUrl());
+		}));
@@ -0,0 +1,55 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteBenchCommandlet.h"
+#include "DSSLiteModule.h"
+#include "DSSLiteBenchmark.h"
+#include "Misc/FileHelper.h"
+
+UDSSLiteBenchCommandlet::UDSSLiteBenchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDSSLiteBenchCommandlet::Main(const FString& Params)
+{
+	FString Filter;
+	FString Output;
+	FString Baseline;
+	double MinSeconds = 0.5;
+	FParse::Value(*Params, TEXT("Filter="), Filter);
+	FParse::Value(*Params, TEXT("Output="), Output);
+	FParse::Value(*Params, TEXT("Baseline="), Baseline);
+	FParse::Value(*Params, TEXT("MinSeconds="), MinSeconds);
+
+	const TArray<FDSSLiteBenchmarkResult> Results = DSSLiteBenchmark::RunAll(Filter, MinSeconds);
+
+	if (!Output.IsEmpty() && !FFileHelper::SaveStringToFile(DSSLiteBenchmark::ToJson(Results), *Output))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Cannot write %s."), *Output);
+		return 1;
+	}
+
+	FString BaselineJson;
+	TArray<FDSSLiteBenchmarkResult> BaselineResults;
+	if (!Baseline.IsEmpty())
+	{
+		if (!FFileHelper::LoadFileToString(BaselineJson, *Baseline) || !DSSLiteBenchmark::FromJson(BaselineJson, BaselineResults))
+		{
+			UE_LOG(LogDSSLite, Error, TEXT("Cannot read baseline %s."), *Baseline);
+			return 1;
+		}
+
+		for (const FDSSLiteBenchmarkResult& Result : Results)
+		{
+			const FDSSLiteBenchmarkResult* Previous = BaselineResults.FindByPredicate([&Result](const FDSSLiteBenchmarkResult& Candidate) { return Candidate.Name == Result.Name; });
+			if (Previous == nullptr || Previous->NsPerOp <= 0.0)
+				continue;
+
+			UE_LOG(LogDSSLite, Display, TEXT("%-40s %+7.1f%% ns/op %+8.2f allocs/op %+10.1f B/op"), *Result.Name, (Result.NsPerOp / Previous->NsPerOp - 1.0) * 100.0, Result.AllocsPerOp - Previous->AllocsPerOp, Result.BytesPerOp - Previous->BytesPerOp);
+		}
+	}
+	return 0;
+}
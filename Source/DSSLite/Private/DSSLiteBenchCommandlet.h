@@ -0,0 +1,22 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DSSLiteBenchCommandlet.generated.h"
+
+/*
+* Runs the DSSLITE_BENCHMARK cases, see DSSLiteBenchmarks.cpp.
+* -run=DSSLiteBench -Filter=Parse -MinSeconds=0.5 -Output=Bench.json -Baseline=Previous.json
+*/
+UCLASS()
+class UDSSLiteBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDSSLiteBenchCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,193 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteBenchmark.h"
+#include "DSSLiteModule.h"
+#include "SignalRValue.h"
+#include "HAL/MallocBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace DSSLiteBenchmark
+{
+	static TArray<TPair<const TCHAR*, FFactory>>& GetCases()
+	{
+		static TArray<TPair<const TCHAR*, FFactory>> Cases;
+		return Cases;
+	}
+
+	FRegistration::FRegistration(const TCHAR* InName, FFactory InFactory)
+	{
+		GetCases().Emplace(InName, InFactory);
+	}
+
+	/*forwards to the engine allocator and counts what the benchmark thread asks for*/
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) :
+			Inner(InInner),
+			ThreadId(FPlatformTLS::GetCurrentThreadId())
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return Inner->GetDescriptiveName();
+		}
+
+		FMalloc* Inner;
+		uint32 ThreadId;
+		uint64 Allocs = 0;
+		uint64 Bytes = 0;
+
+	private:
+		void Track(SIZE_T Count)
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				++Allocs;
+				Bytes += Count;
+			}
+		}
+	};
+
+	static FDSSLiteBenchmarkResult RunCase(const TCHAR* Name, FFactory Factory, double MinSeconds)
+	{
+		FDSSLiteBenchmarkResult Result;
+		Result.Name = Name;
+		FBody Body = Factory();
+
+		// warm up, then double the batch until it fills the budget
+		Body();
+		uint64 Batch = 1;
+		double Elapsed = 0.0;
+		for (;;)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (uint64 Index = 0; Index < Batch; ++Index)
+			{
+				Body();
+			}
+			Elapsed = FPlatformTime::Seconds() - StartTime;
+			if (Elapsed >= MinSeconds || Batch >= (1ull << 40))
+				break;
+			Batch = Elapsed > 0.0 ? FMath::Max(Batch * 2, (uint64)(Batch * MinSeconds / Elapsed * 1.1)) : Batch * 10;
+		}
+		Result.Iterations = Batch;
+		Result.NsPerOp = Elapsed * 1e9 / Batch;
+
+		// allocations in a separate pass so counting does not skew the timing
+		const uint64 AllocIterations = FMath::Clamp<uint64>(Batch, 1, 1000);
+		FCountingMalloc* Counter = new FCountingMalloc(GMalloc);
+		GMalloc = Counter;
+		for (uint64 Index = 0; Index < AllocIterations; ++Index)
+		{
+			Body();
+		}
+		GMalloc = Counter->Inner;
+		Result.AllocsPerOp = (double)Counter->Allocs / AllocIterations;
+		Result.BytesPerOp = (double)Counter->Bytes / AllocIterations;
+		// leaked on purpose, another thread may still be inside it
+		return Result;
+	}
+
+	TArray<FDSSLiteBenchmarkResult> RunAll(const FString& Filter, double MinSeconds)
+	{
+		TArray<FDSSLiteBenchmarkResult> Results;
+		UE_LOG(LogDSSLite, Display, TEXT("sizeof(FSignalRValue) = %d"), (int32)sizeof(FSignalRValue));
+		for (const TPair<const TCHAR*, FFactory>& Case : GetCases())
+		{
+			if (!Filter.IsEmpty() && !FString(Case.Key).Contains(Filter))
+				continue;
+
+			Results.Add(RunCase(Case.Key, Case.Value, MinSeconds));
+			const FDSSLiteBenchmarkResult& Result = Results.Last();
+			UE_LOG(LogDSSLite, Display, TEXT("%-40s %12.1f ns/op %8.2f allocs/op %10.1f B/op  (%llu iterations)"), *Result.Name, Result.NsPerOp, Result.AllocsPerOp, Result.BytesPerOp, Result.Iterations);
+		}
+		return Results;
+	}
+
+	FString ToJson(const TArray<FDSSLiteBenchmarkResult>& Results)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FDSSLiteBenchmarkResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->SetStringField(TEXT("name"), Result.Name);
+			Object->SetNumberField(TEXT("iterations"), Result.Iterations);
+			Object->SetNumberField(TEXT("ns_per_op"), Result.NsPerOp);
+			Object->SetNumberField(TEXT("allocs_per_op"), Result.AllocsPerOp);
+			Object->SetNumberField(TEXT("bytes_per_op"), Result.BytesPerOp);
+			Values.Add(MakeShared<FJsonValueObject>(Object));
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetNumberField(TEXT("version"), 1);
+		Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+		Root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+		Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+		Root->SetNumberField(TEXT("signalr_value_size"), sizeof(FSignalRValue));
+		Root->SetArrayField(TEXT("results"), Values);
+
+		FString Json;
+		FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&Json));
+		return Json;
+	}
+
+	bool FromJson(const FString& Json, TArray<FDSSLiteBenchmarkResult>& OutResults)
+	{
+		TSharedPtr<FJsonObject> Root;
+		const TArray<TSharedPtr<FJsonValue>>* Values;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("results"), Values))
+			return false;
+
+		for (const TSharedPtr<FJsonValue>& Value : *Values)
+		{
+			const TSharedPtr<FJsonObject> Object = Value->AsObject();
+			if (!Object.IsValid())
+				continue;
+
+			FDSSLiteBenchmarkResult& Result = OutResults.AddDefaulted_GetRef();
+			Object->TryGetStringField(TEXT("name"), Result.Name);
+			int64 Iterations = 0;
+			Object->TryGetNumberField(TEXT("iterations"), Iterations);
+			Result.Iterations = Iterations;
+			Object->TryGetNumberField(TEXT("ns_per_op"), Result.NsPerOp);
+			Object->TryGetNumberField(TEXT("allocs_per_op"), Result.AllocsPerOp);
+			Object->TryGetNumberField(TEXT("bytes_per_op"), Result.BytesPerOp);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDSSLiteBenchmarkResult
+{
+	FString Name;
+	uint64 Iterations = 0;
+	double NsPerOp = 0.0;
+	double AllocsPerOp = 0.0;
+	double BytesPerOp = 0.0;
+};
+
+/*
+* Microbenchmark registry. A case is a factory that builds its corpus outside the measurement and returns the body to time:
+*
+* DSSLITE_BENCHMARK(Base64Encode)
+* {
+*	std::string Corpus(256, 'x');
+*	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(jwt::base::encode<jwt::alphabet::base64>(Corpus)); };
+* }
+*/
+namespace DSSLiteBenchmark
+{
+	typedef TFunction<void()> FBody;
+	typedef FBody(*FFactory)();
+
+	struct FRegistration
+	{
+		FRegistration(const TCHAR* InName, FFactory InFactory);
+	};
+
+	/*runs every case whose name contains Filter, MinSeconds is the timed budget per case*/
+	TArray<FDSSLiteBenchmarkResult> RunAll(const FString& Filter, double MinSeconds);
+
+	FString ToJson(const TArray<FDSSLiteBenchmarkResult>& Results);
+	bool FromJson(const FString& Json, TArray<FDSSLiteBenchmarkResult>& OutResults);
+
+	/*keeps the optimizer from discarding a result*/
+	template<typename T>
+	FORCEINLINE void DoNotOptimize(const T& Value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		static volatile const void* Sink;
+		Sink = &Value;
+#else
+		asm volatile("" : : "r,m"(Value) : "memory");
+#endif
+	}
+}
+
+#define DSSLITE_BENCHMARK(Name) \
+	static DSSLiteBenchmark::FBody DSSLiteBenchmark_##Name(); \
+	static DSSLiteBenchmark::FRegistration DSSLiteBenchmarkRegistration_##Name(TEXT(#Name), &DSSLiteBenchmark_##Name); \
+	static DSSLiteBenchmark::FBody DSSLiteBenchmark_##Name()
@@ -0,0 +1,332 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteBenchmark.h"
+#include "SignalRValue.h"
+#include "ConnectionStats.h"
+#include "DSSLiteTokens.h"
+#include "../ThirdParty/SignalR/Private/JsonHubProtocol.h"
+#include "../ThirdParty/SignalR/Private/HandshakeProtocol.h"
+#include "../ThirdParty/SignalR/Private/CallbackManager.h"
+#include "DSSLiteJwt.h"
+
+/*
+* Fixed corpora, shaped after real DSS traffic. Keep them stable, results are only comparable across versions on the same input.
+*/
+static const TCHAR* ClientTravelRecord = TEXT("{\"type\":1,\"target\":\"ClientTravel\",\"arguments\":[\"127.0.0.1\",7777,\"Player42\",\"b2c7a6f0-3c1e-4a7e-9d1a-5f0c2e8d9b41\",2,1520.5,-340.25,88,90]}\x1e");
+static const TCHAR* CompletionRecord = TEXT("{\"type\":3,\"invocationId\":\"17\",\"result\":{\"map\":\"Lobby\",\"port\":7777,\"players\":[\"A\",\"B\",\"C\"],\"ready\":true,\"load\":0.35}}\x1e");
+
+static FString MakeBatch(int32 Count)
+{
+	FString Batch;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Batch += ClientTravelRecord;
+	}
+	return Batch;
+}
+
+static FSignalRValue MakeObject()
+{
+	TMap<FString, FSignalRValue> Fields;
+	Fields.Add(TEXT("ServerIP"), FString(TEXT("127.0.0.1")));
+	Fields.Add(TEXT("Port"), 7777);
+	Fields.Add(TEXT("PlayerName"), FString(TEXT("Player42")));
+	Fields.Add(TEXT("ConnectionID"), FString(TEXT("b2c7a6f0-3c1e-4a7e-9d1a-5f0c2e8d9b41")));
+	Fields.Add(TEXT("Options"), 2);
+	Fields.Add(TEXT("X"), 1520.5);
+	Fields.Add(TEXT("Y"), -340.25);
+	Fields.Add(TEXT("Z"), 88.0);
+	return FSignalRValue(MoveTemp(Fields));
+}
+
+// FJsonHubProtocol
+
+DSSLITE_BENCHMARK(ParseInvocation)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	const FString Corpus = ClientTravelRecord;
+	return [Protocol, Corpus]() { DSSLiteBenchmark::DoNotOptimize(Protocol->ParseMessages(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ParseCompletion)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	const FString Corpus = CompletionRecord;
+	return [Protocol, Corpus]() { DSSLiteBenchmark::DoNotOptimize(Protocol->ParseMessages(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ParseBatch16)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	const FString Corpus = MakeBatch(16);
+	return [Protocol, Corpus]() { DSSLiteBenchmark::DoNotOptimize(Protocol->ParseMessages(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ParseBatch16Borrowed)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	const FString Corpus = MakeBatch(16);
+	return [Protocol, Corpus]() { DSSLiteBenchmark::DoNotOptimize(Protocol->ParseMessages(Corpus, true)); };
+}
+
+DSSLITE_BENCHMARK(SerializeInvocation)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	TSharedRef<FInvocationMessage> Message = MakeShared<FInvocationMessage>(TEXT("17"), TEXT("TravelWithCoordinates"), TArray<FSignalRValue>{ FString(TEXT("Lobby")), false, FString(), 1520.5, -340.25, 88.0, 90.0 });
+	return [Protocol, Message]() { DSSLiteBenchmark::DoNotOptimize(Protocol->SerializeMessage(&Message.Get())); };
+}
+
+DSSLITE_BENCHMARK(SerializeCompletion)
+{
+	TSharedRef<FJsonHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	TSharedRef<FCompletionMessage> Message = MakeShared<FCompletionMessage>(TEXT("17"), FString(), MakeObject(), true);
+	return [Protocol, Message]() { DSSLiteBenchmark::DoNotOptimize(Protocol->SerializeMessage(&Message.Get())); };
+}
+
+// FHandshakeProtocol
+
+DSSLITE_BENCHMARK(HandshakeCreate)
+{
+	TSharedPtr<IHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+	return [Protocol]() { DSSLiteBenchmark::DoNotOptimize(FHandshakeProtocol::CreateHandshakeMessage(Protocol)); };
+}
+
+DSSLITE_BENCHMARK(HandshakeParse)
+{
+	const FString Corpus = FString(TEXT("{}\x1e")) + ClientTravelRecord;
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(FHandshakeProtocol::ParseHandshakeResponse(Corpus)); };
+}
+
+// FSignalRValue
+
+DSSLITE_BENCHMARK(ValueConstructString)
+{
+	const FString Corpus = TEXT("b2c7a6f0-3c1e-4a7e-9d1a-5f0c2e8d9b41");
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(FSignalRValue(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ValueConstructShortString)
+{
+	const FString Corpus = TEXT("Player42");
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(FSignalRValue(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ValueClientTravelArguments)
+{
+	const FString ServerIP = TEXT("127.0.0.1");
+	const FString PlayerName = TEXT("Player42");
+	const FString ConnectionId = TEXT("b2c7a6f0-3c1e-4a7e-9d1a-5f0c2e8d9b41");
+	return [ServerIP, PlayerName, ConnectionId]()
+	{
+		TArray<FSignalRValue> Arguments{ ServerIP, 7777, PlayerName, ConnectionId, 2, 1520.5, -340.25, 88.0, 90.0 };
+		DSSLiteBenchmark::DoNotOptimize(Arguments);
+	};
+}
+
+DSSLITE_BENCHMARK(ValueConstructNumber)
+{
+	return []() { DSSLiteBenchmark::DoNotOptimize(FSignalRValue(1520.5)); };
+}
+
+DSSLITE_BENCHMARK(ValueConstructObject)
+{
+	return []() { DSSLiteBenchmark::DoNotOptimize(MakeObject()); };
+}
+
+DSSLITE_BENCHMARK(ValueCopyObject)
+{
+	const FSignalRValue Corpus = MakeObject();
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(FSignalRValue(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ValueMoveObject)
+{
+	TSharedRef<FSignalRValue> Corpus = MakeShared<FSignalRValue>(MakeObject());
+	return [Corpus]()
+	{
+		FSignalRValue Moved(MoveTemp(Corpus.Get()));
+		DSSLiteBenchmark::DoNotOptimize(Moved);
+		Corpus.Get() = MoveTemp(Moved);
+	};
+}
+
+DSSLITE_BENCHMARK(ValueFromStruct)
+{
+	FDSSConnectionStats Corpus;
+	Corpus.BytesIn = 18432;
+	Corpus.FramesIn = 96;
+	Corpus.RecordsIn = 112;
+	Corpus.ParseTimeMs = 1.75f;
+	Corpus.InvokeRTTMs = 23.5f;
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(FSignalRValue::FromStruct(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(ValueToStruct)
+{
+	FDSSConnectionStats Stats;
+	Stats.BytesIn = 18432;
+	Stats.InvokeRTTMs = 23.5f;
+	const FSignalRValue Corpus = FSignalRValue::FromStruct(Stats);
+	return [Corpus]()
+	{
+		FDSSConnectionStats Decoded;
+		Corpus.ToStruct(Decoded);
+		DSSLiteBenchmark::DoNotOptimize(Decoded);
+	};
+}
+
+// FCallbackManager
+
+DSSLITE_BENCHMARK(CallbackRegisterInvoke)
+{
+	TSharedRef<FCallbackManager> Manager = MakeShared<FCallbackManager>();
+	const FSignalRValue Result = 42;
+	return [Manager, Result]()
+	{
+		auto Callback = Manager->RegisterCallback(TEXT("Echo"));
+		Callback.Get<1>().BindLambda([](const FSignalRValue& Value) { DSSLiteBenchmark::DoNotOptimize(Value); });
+		Manager->InvokeCallback(Callback.Get<0>(), Result, true);
+	};
+}
+
+// jwt-cpp
+
+DSSLITE_BENCHMARK(Base64UrlEncode256)
+{
+	std::string Corpus;
+	for (int32 Index = 0; Index < 256; ++Index)
+	{
+		Corpus.push_back((char)(Index * 37));
+	}
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(jwt::base::encode<jwt::alphabet::base64url>(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(Base64UrlDecode256)
+{
+	std::string Binary;
+	for (int32 Index = 0; Index < 256; ++Index)
+	{
+		Binary.push_back((char)(Index * 37));
+	}
+	const std::string Corpus = jwt::base::encode<jwt::alphabet::base64url>(Binary);
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(jwt::base::decode<jwt::alphabet::base64url>(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(Base64UrlDecodeTokenPayload)
+{
+	// what jwt::decode does with the payload of a DSS client token
+	const std::string Payload = "{\"exp\":1700000000,\"name\":\"Player42\",\"role\":\"client\"}";
+	const std::string Corpus = jwt::base::trim<jwt::alphabet::base64url>(jwt::base::encode<jwt::alphabet::base64url>(Payload));
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(jwt::base::decode<jwt::alphabet::base64url>(jwt::base::pad<jwt::alphabet::base64url>(Corpus))); };
+}
+
+DSSLITE_BENCHMARK(Base64Decode4K)
+{
+	std::string Binary;
+	for (int32 Index = 0; Index < 4096; ++Index)
+	{
+		Binary.push_back((char)(Index * 37));
+	}
+	const std::string Corpus = jwt::base::encode<jwt::alphabet::base64>(Binary);
+	return [Corpus]() { DSSLiteBenchmark::DoNotOptimize(jwt::base::decode<jwt::alphabet::base64>(Corpus)); };
+}
+
+DSSLITE_BENCHMARK(HmacSha256SignReused)
+{
+	// one keyed instance, as a front end verifying many tokens would hold
+	TSharedRef<jwt::algorithm::hs256> Algorithm = MakeShared<jwt::algorithm::hs256>("0000000000");
+	const std::string Corpus = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXUyJ9.eyJleHAiOjE3MDAwMDAwMDAsIm5hbWUiOiJQbGF5ZXI0MiIsInJvbGUiOiJjbGllbnQifQ";
+	return [Algorithm, Corpus]()
+	{
+		std::error_code Error;
+		DSSLiteBenchmark::DoNotOptimize(Algorithm->sign(Corpus, Error));
+	};
+}
+
+DSSLITE_BENCHMARK(JwtSignClientHS256)
+{
+	return []()
+	{
+		DSSLiteBenchmark::DoNotOptimize(jwt::create()
+			.set_payload_claim("name", jwt::claim(std::string("Player42")))
+			.set_payload_claim("role", jwt::claim(std::string("client")))
+			.set_expires_at(std::chrono::system_clock::time_point(std::chrono::seconds{ 1700000000 }))
+			.sign(jwt::algorithm::hs256{ "0000000000" }));
+	};
+}
+
+DSSLITE_BENCHMARK(JwtSignClientFixed)
+{
+	const FString PlayerName = TEXT("Player42");
+	const FString SigningKey = TEXT("0000000000");
+	return [PlayerName, SigningKey]() { DSSLiteBenchmark::DoNotOptimize(DSSLiteTokens::CreateClientToken(PlayerName, SigningKey)); };
+}
+
+DSSLITE_BENCHMARK(VerifyClientTokenCold)
+{
+	const FString Token = DSSLiteTokens::CreateClientToken(TEXT("Player42"), TEXT("0000000000"), 3600);
+	TSharedRef<DSSLiteTokens::FClientTokenVerifier> Verifier = MakeShared<DSSLiteTokens::FClientTokenVerifier>(TEXT("0000000000"));
+	return [Token, Verifier]()
+	{
+		Verifier->ResetCache();
+		FString PlayerName;
+		DSSLiteBenchmark::DoNotOptimize(Verifier->Verify(Token, PlayerName));
+	};
+}
+
+DSSLITE_BENCHMARK(VerifyClientTokenCached)
+{
+	const FString Token = DSSLiteTokens::CreateClientToken(TEXT("Player42"), TEXT("0000000000"), 3600);
+	TSharedRef<DSSLiteTokens::FClientTokenVerifier> Verifier = MakeShared<DSSLiteTokens::FClientTokenVerifier>(TEXT("0000000000"));
+	return [Token, Verifier]()
+	{
+		FString PlayerName;
+		DSSLiteBenchmark::DoNotOptimize(Verifier->Verify(Token, PlayerName));
+	};
+}
+
+namespace
+{
+	/*decode and verify cost per JSON traits, on the DSS client token*/
+	template<typename Traits>
+	DSSLiteBenchmark::FBody JwtDecodeCase()
+	{
+		const std::string Token = TCHAR_TO_UTF8(*DSSLiteTokens::CreateClientToken(TEXT("Player42"), TEXT("0000000000"), 3600));
+		return [Token]() { DSSLiteBenchmark::DoNotOptimize(jwt::decode<Traits>(Token).get_payload_claim("name").as_string()); };
+	}
+
+	template<typename Traits>
+	DSSLiteBenchmark::FBody JwtVerifyCase()
+	{
+		const std::string Token = TCHAR_TO_UTF8(*DSSLiteTokens::CreateClientToken(TEXT("Player42"), TEXT("0000000000"), 3600));
+		const auto Verifier = MakeShared<const jwt::verifier<jwt::default_clock, Traits>>(jwt::verifyToken<jwt::default_clock, Traits>(jwt::default_clock{})
+			.allow_algorithm(jwt::algorithm::hs256("0000000000"))
+			.with_custom_claim("role", "client"));
+		return [Token, Verifier]()
+		{
+			std::error_code Error;
+			Verifier->verifyToken(jwt::decode<Traits>(Token), Error);
+			DSSLiteBenchmark::DoNotOptimize(Error);
+		};
+	}
+}
+
+DSSLITE_BENCHMARK(JwtDecodePicojson)
+{
+	return JwtDecodeCase<jwt::picojson_traits>();
+}
+
+DSSLITE_BENCHMARK(JwtDecodeFlatJson)
+{
+	return JwtDecodeCase<jwt::flat_json_traits>();
+}
+
+DSSLITE_BENCHMARK(JwtVerifyPicojson)
+{
+	return JwtVerifyCase<jwt::picojson_traits>();
+}
+
+DSSLITE_BENCHMARK(JwtVerifyFlatJson)
+{
+	return JwtVerifyCase<jwt::flat_json_traits>();
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Tickable.h"
+#include "HttpModule.h"
+#include "HttpManager.h"
+
+namespace DSSLiteCommandlet
+{
+	/*ticks the engine pieces hub connections depend on until the condition holds or the timeout expires*/
+	inline bool PumpUntil(TFunctionRef<bool()> Condition, double TimeoutSeconds)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		double LastTime = StartTime;
+		while (!Condition())
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Now - StartTime > TimeoutSeconds || IsEngineExitRequested())
+				return false;
+
+			const float DeltaTime = Now - LastTime;
+			LastTime = Now;
+			FTSTicker::GetCoreTicker().Tick(DeltaTime);
+			FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+			FTickableGameObject::TickObjects(nullptr, LEVELTICK_All, false, DeltaTime);
+			FPlatformProcess::Sleep(0.f);
+		}
+		return true;
+	}
+}
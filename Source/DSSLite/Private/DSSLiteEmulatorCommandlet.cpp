@@ -0,0 +1,149 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteEmulatorCommandlet.h"
+#include "DSSLiteModule.h"
+#include "DSSLiteTokens.h"
+#include "DSSEmulator.h"
+#include "LatencyHistogram.h"
+#include "DSSLiteCommandletUtils.h"
+
+using DSSLiteCommandlet::PumpUntil;
+
+UDSSLiteEmulatorCommandlet::UDSSLiteEmulatorCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDSSLiteEmulatorCommandlet::Main(const FString& Params)
+{
+	FString ScenarioFile;
+	double Timeout = 60.0;
+	FParse::Value(*Params, TEXT("Scenario="), ScenarioFile);
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+
+	FDSSEmulatorScenario Scenario;
+	if (!FDSSEmulatorScenario::LoadFromFile(ScenarioFile, Scenario))
+		return 1;
+
+	const int32 NumClients = FMath::Max(1, Scenario.Clients);
+	FDSSEmulator Emulator(Scenario);
+
+	// servers first so ClientTravel carries their connection id and scripted events reach them
+	TArray<TSharedPtr<IHubConnection>> ServerHubs;
+	int32 NumServersConnected = 0;
+	int32 NumServerCloses = 0;
+	int32 NumPlayerDisconnects = 0;
+	for (const FDSSEmulatorLevel& Level : Scenario.Levels)
+	{
+		TSharedPtr<IHubConnection> Hub = FDSSLiteModule::Get().CreateHubConnection(Emulator.GetUrl(TEXT("/ServersHub")), DSSLiteTokens::CreateServerToken(Level.Port, Scenario.SigningKey, Scenario.SigningKey));
+		Hub->OnConnected().AddLambda([&NumServersConnected]() { ++NumServersConnected; });
+		Hub->On(TEXT("ServerClose")).BindLambda([&NumServerCloses](const TArray<FSignalRValue>& Arguments) { ++NumServerCloses; });
+		Hub->On(TEXT("PlayerDisconnected")).BindLambda([&NumPlayerDisconnects](const TArray<FSignalRValue>& Arguments) { ++NumPlayerDisconnects; });
+		Hub->Start();
+		ServerHubs.Add(Hub);
+	}
+
+	struct FClientState
+	{
+		TSharedPtr<IHubConnection> Hub;
+		bool bConnected = false;
+		int32 TravelsSent = 0;
+		int32 TravelsDone = 0;
+		double RequestTime = 0.0;
+	};
+	TArray<FClientState> ClientStates;
+	ClientStates.SetNum(NumClients);
+
+	FLatencyHistogram ConnectLatency;
+	FLatencyHistogram TravelLatency;
+	int32 NumConnected = 0;
+	int32 NumTravelsDone = 0;
+
+	auto SendTravel = [&Scenario, &ClientStates](int32 Index)
+	{
+		FClientState& State = ClientStates[Index];
+		const FDSSEmulatorLevel& Level = Scenario.Levels[(Index + State.TravelsSent) % Scenario.Levels.Num()];
+		++State.TravelsSent;
+		State.RequestTime = FPlatformTime::Seconds();
+		switch (Scenario.TravelOptions)
+		{
+		case 1:
+			State.Hub->Send(TEXT("TravelWithTag"), Level.Name, false, FString(), Scenario.TravelTag);
+			break;
+		case 2:
+			State.Hub->Send(TEXT("TravelWithCoordinates"), Level.Name, false, FString(), Scenario.TravelLocation.X, Scenario.TravelLocation.Y, Scenario.TravelLocation.Z, Scenario.TravelYaw);
+			break;
+		default:
+			State.Hub->Send(TEXT("Travel"), Level.Name, false, FString());
+			break;
+		}
+	};
+
+	PumpUntil([&]() { return NumServersConnected == ServerHubs.Num(); }, Timeout);
+	Emulator.Start();
+
+	const double ConnectStart = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		const FString PlayerName = FString::Printf(TEXT("Player%d"), Index);
+		TSharedPtr<IHubConnection> Hub = FDSSLiteModule::Get().CreateHubConnection(Emulator.GetUrl(TEXT("/ClientsHub")), DSSLiteTokens::CreateClientToken(PlayerName, Scenario.SigningKey));
+		Hub->On(TEXT("OnConnect")).BindLambda([&, Index, ConnectStart](const TArray<FSignalRValue>& Arguments)
+			{
+				if (ClientStates[Index].bConnected)
+					return;
+				ClientStates[Index].bConnected = true;
+				++NumConnected;
+				ConnectLatency.Record((FPlatformTime::Seconds() - ConnectStart) * 1000000.0);
+				if (Scenario.TravelsPerClient > 0)
+				{
+					SendTravel(Index);
+				}
+			});
+		Hub->On(TEXT("ClientTravel")).BindLambda([&, Index](const TArray<FSignalRValue>& Arguments)
+			{
+				FClientState& State = ClientStates[Index];
+				TravelLatency.Record((FPlatformTime::Seconds() - State.RequestTime) * 1000000.0);
+				++State.TravelsDone;
+				++NumTravelsDone;
+				if (State.TravelsSent < Scenario.TravelsPerClient)
+				{
+					SendTravel(Index);
+				}
+			});
+		ClientStates[Index].Hub = Hub;
+		Hub->Start();
+	}
+
+	const int32 NumTravels = NumClients * FMath::Max(0, Scenario.TravelsPerClient);
+	if (!PumpUntil([&]() { return NumConnected == NumClients; }, Timeout))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Only %d/%d clients got OnConnect before the timeout."), NumConnected, NumClients);
+		return 1;
+	}
+	UE_LOG(LogDSSLite, Display, TEXT("OnConnect: %d clients, p50 %.3f ms, p99 %.3f ms, max %.3f ms"), NumClients, ConnectLatency.GetPercentile(50.0) / 1000.0, ConnectLatency.GetPercentile(99.0) / 1000.0, ConnectLatency.GetMax() / 1000.0);
+
+	// lost frames never travel, only count what came back
+	PumpUntil([&]() { return NumTravelsDone == NumTravels; }, Timeout);
+	const double Elapsed = FPlatformTime::Seconds() - ConnectStart;
+	UE_LOG(LogDSSLite, Display, TEXT("Travel: %d/%d ClientTravel in %.3f ms, %.0f travels/s"), NumTravelsDone, NumTravels, Elapsed * 1000.0, Elapsed > 0 ? NumTravelsDone / Elapsed : 0.0);
+	UE_LOG(LogDSSLite, Display, TEXT("Travel latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms"), TravelLatency.GetPercentile(50.0) / 1000.0, TravelLatency.GetPercentile(90.0) / 1000.0, TravelLatency.GetPercentile(99.0) / 1000.0, TravelLatency.GetMax() / 1000.0);
+
+	PumpUntil([&]() { return !Emulator.HasPendingEvents(); }, Timeout);
+
+	for (const FClientState& State : ClientStates)
+	{
+		State.Hub->Stop();
+	}
+	PumpUntil([&]() { return NumPlayerDisconnects >= NumClients * ServerHubs.Num(); }, Timeout);
+	UE_LOG(LogDSSLite, Display, TEXT("Server pushes: %d ServerClose, %d PlayerDisconnected"), NumServerCloses, NumPlayerDisconnects);
+
+	for (const TSharedPtr<IHubConnection>& Hub : ServerHubs)
+	{
+		Hub->Stop();
+	}
+	PumpUntil([&]() { return Emulator.GetServer().GetNumClients() == 0; }, Timeout);
+	return 0;
+}
@@ -0,0 +1,23 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DSSLiteEmulatorCommandlet.generated.h"
+
+/*
+* Runs a FDSSEmulator scenario end to end: one ServersHub connection per level, Clients ClientsHub connections
+* each sending TravelsPerClient travels, reports request to ClientTravel latency and travel throughput.
+* -run=DSSLiteEmulator -Scenario=Path/To/Scenario.json -Timeout=60
+*/
+UCLASS()
+class UDSSLiteEmulatorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDSSLiteEmulatorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
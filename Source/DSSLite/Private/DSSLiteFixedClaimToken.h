@@ -0,0 +1,167 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "DSSLiteJwt.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/*
+* Engine independent, shared by DSSLiteTokens.cpp and the host tests (Host/Tests/JwtTests.cpp) that check it against jwt::builder.
+*/
+namespace DSSLiteJwt
+{
+	/*base64url of {"alg":"HS256"}, the header jwt::builder writes for hs256*/
+	static const char HS256Header[] = "eyJhbGciOiJIUzI1NiJ9";
+
+	/*
+	* Writes the fixed DSS claim sets straight into stack buffers, byte for byte what jwt::builder produces:
+	* keys in ascending order, strings escaped like picojson, unpadded base64url. Claims that do not fit make Sign fail.
+	* Strings are UTF-8 bytes, written as they are apart from the escapes.
+	*/
+	class FFixedClaimToken
+	{
+	public:
+		FFixedClaimToken()
+		{
+			Append('{');
+		}
+
+		/*keys must be added in ascending order*/
+		void AddInteger(const char* Key, int64_t Value)
+		{
+			AddKey(Key);
+			char Digits[24];
+			const int Length = std::snprintf(Digits, sizeof(Digits), "%lld", (long long)Value);
+			Append(Digits, Length);
+		}
+
+		void AddString(const char* Key, const char* Value, int Length)
+		{
+			AddKey(Key);
+			AppendEscaped(Value, Length);
+		}
+
+		/*OutToken points into this object, it is not null terminated*/
+		bool Sign(const jwt::algorithm::hs256& Algorithm, const char*& OutToken, int& OutLength)
+		{
+			Append('}');
+			if (bOverflow)
+				return false;
+
+			// header.payload.signature, the signature is computed over the first two parts in place
+			int TokenLength = sizeof(HS256Header) - 1;
+			std::memcpy(Token, HS256Header, TokenLength);
+			Token[TokenLength++] = '.';
+			TokenLength += Base64UrlEncode(reinterpret_cast<const uint8_t*>(Json), JsonLength, Token + TokenLength);
+
+			unsigned char Signature[EVP_MAX_MD_SIZE];
+			unsigned int SignatureLength = 0;
+			if (!Algorithm.sign(Token, TokenLength, Signature, SignatureLength))
+				return false;
+
+			Token[TokenLength++] = '.';
+			TokenLength += Base64UrlEncode(Signature, (int)SignatureLength, Token + TokenLength);
+
+			OutToken = Token;
+			OutLength = TokenLength;
+			return true;
+		}
+
+	private:
+		static constexpr int JsonCapacity = 768;
+
+		void AddKey(const char* Key)
+		{
+			Append(JsonLength > 1 ? ",\"" : "\"", JsonLength > 1 ? 2 : 1);
+			Append(Key, (int)std::strlen(Key));
+			Append("\":", 2);
+		}
+
+		void Append(char Char)
+		{
+			Append(&Char, 1);
+		}
+
+		void Append(const char* Chars, int Length)
+		{
+			if (JsonLength + Length > JsonCapacity)
+			{
+				bOverflow = true;
+				return;
+			}
+			std::memcpy(Json + JsonLength, Chars, Length);
+			JsonLength += Length;
+		}
+
+		/*same escapes as picojson::serialize_str*/
+		void AppendEscaped(const char* Value, int Length)
+		{
+			Append('"');
+			for (int Index = 0; Index < Length; ++Index)
+			{
+				const char Char = Value[Index];
+				switch (Char)
+				{
+				case '"': Append("\\\"", 2); break;
+				case '\\': Append("\\\\", 2); break;
+				case '/': Append("\\/", 2); break;
+				case '\b': Append("\\b", 2); break;
+				case '\f': Append("\\f", 2); break;
+				case '\n': Append("\\n", 2); break;
+				case '\r': Append("\\r", 2); break;
+				case '\t': Append("\\t", 2); break;
+				default:
+					if (static_cast<unsigned char>(Char) < 0x20 || Char == 0x7f)
+					{
+						char Escaped[7];
+						std::snprintf(Escaped, sizeof(Escaped), "\\u%04x", Char & 0xff);
+						Append(Escaped, 6);
+					}
+					else
+					{
+						Append(Char);
+					}
+					break;
+				}
+			}
+			Append('"');
+		}
+
+		static int Base64UrlEncode(const uint8_t* In, int Length, char* Out)
+		{
+			const std::array<char, 64>& Alphabet = jwt::alphabet::base64url::data();
+			char* Start = Out;
+			int Index = 0;
+			for (; Index + 3 <= Length; Index += 3)
+			{
+				const uint32_t Triple = (uint32_t(In[Index]) << 16) | (uint32_t(In[Index + 1]) << 8) | uint32_t(In[Index + 2]);
+				*Out++ = Alphabet[(Triple >> 18) & 0x3F];
+				*Out++ = Alphabet[(Triple >> 12) & 0x3F];
+				*Out++ = Alphabet[(Triple >> 6) & 0x3F];
+				*Out++ = Alphabet[Triple & 0x3F];
+			}
+			if (Index < Length)
+			{
+				const uint32_t Triple = (uint32_t(In[Index]) << 16) | (Index + 1 < Length ? uint32_t(In[Index + 1]) << 8 : 0);
+				*Out++ = Alphabet[(Triple >> 18) & 0x3F];
+				*Out++ = Alphabet[(Triple >> 12) & 0x3F];
+				if (Index + 1 < Length)
+				{
+					*Out++ = Alphabet[(Triple >> 6) & 0x3F];
+				}
+			}
+			return (int)(Out - Start);
+		}
+
+		char Json[JsonCapacity];
+		int JsonLength = 0;
+		bool bOverflow = false;
+
+		/*header, encoded payload and encoded signature*/
+		char Token[sizeof(HS256Header) + JsonCapacity * 4 / 3 + 4 + (EVP_MAX_MD_SIZE * 4 / 3 + 4)];
+	};
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "../ThirdParty/jwt-cpp/jwt.h"
+#include "../ThirdParty/jwt-cpp/flat_json.h"
+
+/*
+* JSON representation behind the plugin's jwt-cpp calls. flat_json keeps claims in one sorted array,
+* build with DSSLITE_JWT_PICOJSON=1 to go back to picojson. Both write byte-identical tokens.
+*/
+#ifndef DSSLITE_JWT_PICOJSON
+#define DSSLITE_JWT_PICOJSON 0
+#endif
+
+namespace DSSLiteJwt
+{
+#if DSSLITE_JWT_PICOJSON
+	using FTraits = jwt::picojson_traits;
+#else
+	using FTraits = jwt::flat_json_traits;
+#endif
+
+	using FClaim = jwt::basic_claim<FTraits>;
+	using FDecoded = jwt::decoded_jwt<FTraits>;
+	using FVerifier = jwt::verifier<jwt::default_clock, FTraits>;
+
+	inline jwt::builder<FTraits> Create()
+	{
+		return jwt::builder<FTraits>();
+	}
+
+	inline FVerifier Verify()
+	{
+		return jwt::verifyToken<jwt::default_clock, FTraits>(jwt::default_clock{});
+	}
+
+	inline FDecoded Decode(const std::string& Token)
+	{
+		return jwt::decode<FTraits>(Token);
+	}
+
+	/*signature, role=client and exp, keyed once*/
+	inline FVerifier ClientVerifier(const std::string& SigningKey)
+	{
+		return Verify()
+			.allow_algorithm(jwt::algorithm::hs256(SigningKey))
+			.with_custom_claim("role", "client");
+	}
+
+	/*
+	* The checks FClientTokenVerifier runs on a cache miss, engine independent so the host tests run them too.
+	* Returns false and fills OutError instead of throwing.
+	*/
+	inline bool VerifyClientToken(const FVerifier& Verifier, const std::string& Token, std::string& OutName, int64_t& OutExp, std::string& OutError)
+	{
+		try
+		{
+			const FDecoded Decoded = Decode(Token);
+			std::error_code Error;
+			Verifier.verifyToken(Decoded, Error);
+			if (Error)
+			{
+				OutError = Error.message();
+				return false;
+			}
+			// a token without exp would never leave the cache
+			if (!Decoded.has_expires_at() || !Decoded.has_payload_claim("name"))
+			{
+				OutError = "exp and name claims are required";
+				return false;
+			}
+			OutName = Decoded.get_payload_claim("name").as_string();
+			OutExp = (int64_t)std::chrono::system_clock::to_time_t(Decoded.get_expires_at());
+			return true;
+		}
+		catch (const std::exception& Exception)
+		{
+			OutError = Exception.what();
+			return false;
+		}
+	}
+}
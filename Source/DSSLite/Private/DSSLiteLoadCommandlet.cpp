@@ -0,0 +1,275 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteLoadCommandlet.h"
+#include "DSSLiteModule.h"
+#include "DSSLiteTokens.h"
+#include "DSSEmulator.h"
+#include "LoopbackSignalRServer.h"
+#include "LatencyHistogram.h"
+#include "DSSLiteCommandletUtils.h"
+#include "HAL/PlatformMemory.h"
+
+using DSSLiteCommandlet::PumpUntil;
+
+/*kept small, there can be tens of thousands of them*/
+struct FLoadClient
+{
+	TSharedPtr<IHubConnection> Hub;
+	double RequestTime = 0.0;//connect or travel request in flight
+	double NextTravelTime = 0.0;
+	uint16 TravelsSent = 0;
+	bool bConnected = false;
+	bool bWaiting = false;
+};
+
+struct FLoadPhase
+{
+	double StartSeconds = FPlatformTime::Seconds();
+
+	FLoadPhase()
+	{
+		FPlatformTime::UpdateCPUTime(0.f);
+	}
+
+	void Report(const TCHAR* Name, int32 Count, const TCHAR* Unit, const FLatencyHistogram& Latency) const
+	{
+		const double Elapsed = FPlatformTime::Seconds() - StartSeconds;
+		FPlatformTime::UpdateCPUTime(Elapsed);
+		const FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+		UE_LOG(LogDSSLite, Display, TEXT("%s: %d in %.3f s, %.0f %s/s, latency p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms, CPU %.1f%%, memory %.1f MB (peak %.1f MB)"),
+			Name, Count, Elapsed, Elapsed > 0 ? Count / Elapsed : 0.0, Unit,
+			Latency.GetPercentile(50.0) / 1000.0, Latency.GetPercentile(90.0) / 1000.0, Latency.GetPercentile(99.0) / 1000.0, Latency.GetMax() / 1000.0,
+			FPlatformTime::GetCPUTime().CPUTimePct, Memory.UsedPhysical / (1024.0 * 1024.0), Memory.PeakUsedPhysical / (1024.0 * 1024.0));
+	}
+};
+
+UDSSLiteLoadCommandlet::UDSSLiteLoadCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDSSLiteLoadCommandlet::Main(const FString& Params)
+{
+	FString Host;
+	FString ScenarioFile;
+	FString SigningKey = TEXT("0000000000");
+	FString NamePrefix = TEXT("LoadPlayer");
+	FString MixString = TEXT("Travel:1");
+	FString MapsString;
+	FString Tag;
+	int32 NumClients = 1000;
+	float ConnectRate = 0.f;
+	int32 TravelsPerClient = 10;
+	float ThinkMs = 0.f;
+	int32 Seed = 0;
+	double Timeout = 120.0;
+	FParse::Value(*Params, TEXT("Host="), Host);
+	FParse::Value(*Params, TEXT("Scenario="), ScenarioFile);
+	FParse::Value(*Params, TEXT("SigningKey="), SigningKey);
+	FParse::Value(*Params, TEXT("NamePrefix="), NamePrefix);
+	FParse::Value(*Params, TEXT("Mix="), MixString);
+	FParse::Value(*Params, TEXT("Maps="), MapsString);
+	FParse::Value(*Params, TEXT("Tag="), Tag);
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("ConnectRate="), ConnectRate);
+	FParse::Value(*Params, TEXT("Travels="), TravelsPerClient);
+	FParse::Value(*Params, TEXT("ThinkMs="), ThinkMs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+	NumClients = FMath::Max(1, NumClients);
+	TravelsPerClient = FMath::Clamp(TravelsPerClient, 0, (int32)MAX_uint16);
+
+	TArray<FString> Maps;
+	MapsString.ParseIntoArray(Maps, TEXT(","));
+
+	TUniquePtr<FDSSEmulator> Emulator;
+	if (!ScenarioFile.IsEmpty())
+	{
+		FDSSEmulatorScenario Scenario;
+		if (!FDSSEmulatorScenario::LoadFromFile(ScenarioFile, Scenario))
+			return 1;
+
+		Emulator = MakeUnique<FDSSEmulator>(Scenario);
+		Emulator->Start();
+		Host = Emulator->GetUrl();
+		SigningKey = Scenario.SigningKey;
+		if (Maps.Num() == 0)
+		{
+			for (const FDSSEmulatorLevel& Level : Scenario.Levels)
+			{
+				Maps.Add(Level.Name);
+			}
+		}
+	}
+	if (Host.IsEmpty())
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Pass -Host=<DSS node> or -Scenario=<emulator scenario>."));
+		return 1;
+	}
+	if (Maps.Num() == 0)
+	{
+		Maps.Add(TEXT("Lobby"));
+	}
+
+	// same url UDSSLiteSubsystem::Connect builds
+	FString Url = Host + TEXT("/ClientsHub");
+	if (!Url.ToLower().StartsWith("http") && !Url.StartsWith(FLoopbackSignalRServer::Scheme))
+		Url = "http://" + Url;
+
+	// Method:Weight pairs
+	TArray<TPair<int32, int32>> Mix;
+	int32 TotalWeight = 0;
+	TArray<FString> MixEntries;
+	MixString.ParseIntoArray(MixEntries, TEXT(","));
+	for (const FString& Entry : MixEntries)
+	{
+		FString Method, Weight;
+		if (!Entry.Split(TEXT(":"), &Method, &Weight))
+		{
+			Method = Entry;
+			Weight = TEXT("1");
+		}
+		const int32 Options = Method == TEXT("Travel") ? 0 : Method == TEXT("TravelWithTag") ? 1 : Method == TEXT("TravelWithCoordinates") ? 2 : INDEX_NONE;
+		if (Options == INDEX_NONE || FCString::Atoi(*Weight) <= 0)
+		{
+			UE_LOG(LogDSSLite, Warning, TEXT("Ignoring travel mix entry '%s'."), *Entry);
+			continue;
+		}
+		TotalWeight += FCString::Atoi(*Weight);
+		Mix.Emplace(Options, TotalWeight);
+	}
+	if (TotalWeight == 0)
+	{
+		Mix.Emplace(0, 1);
+		TotalWeight = 1;
+	}
+
+	FRandomStream Random(Seed);
+	TArray<FLoadClient> Clients;
+	Clients.SetNum(NumClients);
+
+	FLatencyHistogram ConnectLatency;
+	FLatencyHistogram TravelLatency;
+	int32 NumOpened = 0;
+	int32 NumConnected = 0;
+	int32 NumErrors = 0;
+	int32 NumTravelsDone = 0;
+	int32 NumTravelsSent = 0;
+
+	auto SendTravel = [&](int32 Index)
+	{
+		FLoadClient& Client = Clients[Index];
+		const int32 Roll = Random.RandRange(1, TotalWeight);
+		const int32 Options = Mix.FindByPredicate([Roll](const TPair<int32, int32>& Entry) { return Roll <= Entry.Value; })->Key;
+		const FString& MapName = Maps[Random.RandRange(0, Maps.Num() - 1)];
+
+		Client.RequestTime = FPlatformTime::Seconds();
+		Client.bWaiting = true;
+		++Client.TravelsSent;
+		++NumTravelsSent;
+		switch (Options)
+		{
+		case 1:
+			Client.Hub->Send(TEXT("TravelWithTag"), MapName, false, FString(), Tag);
+			break;
+		case 2:
+			Client.Hub->Send(TEXT("TravelWithCoordinates"), MapName, false, FString(), Random.FRandRange(-1000.0, 1000.0), Random.FRandRange(-1000.0, 1000.0), 0.0, Random.FRandRange(0.0, 360.0));
+			break;
+		default:
+			Client.Hub->Send(TEXT("Travel"), MapName, false, FString());
+			break;
+		}
+	};
+
+	auto OpenClient = [&](int32 Index)
+	{
+		FLoadClient& Client = Clients[Index];
+		Client.Hub = FDSSLiteModule::Get().CreateHubConnection(Url, DSSLiteTokens::CreateClientToken(FString::Printf(TEXT("%s%d"), *NamePrefix, Index), SigningKey));
+		Client.Hub->OnConnectionError().AddLambda([&NumErrors](const FString& Error) { ++NumErrors; });
+		Client.Hub->On(TEXT("OnConnect")).BindLambda([&, Index](const TArray<FSignalRValue>& Arguments)
+			{
+				FLoadClient& Client = Clients[Index];
+				if (Client.bConnected)
+					return;
+				Client.bConnected = true;
+				++NumConnected;
+				ConnectLatency.Record((FPlatformTime::Seconds() - Client.RequestTime) * 1000000.0);
+			});
+		Client.Hub->On(TEXT("ClientTravel")).BindLambda([&, Index](const TArray<FSignalRValue>& Arguments)
+			{
+				FLoadClient& Client = Clients[Index];
+				if (!Client.bWaiting)
+					return;
+				Client.bWaiting = false;
+				Client.NextTravelTime = FPlatformTime::Seconds() + ThinkMs / 1000.0;
+				++NumTravelsDone;
+				TravelLatency.Record((FPlatformTime::Seconds() - Client.RequestTime) * 1000000.0);
+			});
+		Client.RequestTime = FPlatformTime::Seconds();
+		Client.Hub->Start();
+	};
+
+	UE_LOG(LogDSSLite, Display, TEXT("Load: %d clients on %s, %d travels each."), NumClients, *Url, TravelsPerClient);
+	const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	// connection storm, ramped by ConnectRate when set
+	{
+		const FLoadPhase Phase;
+		const bool bConnected = PumpUntil([&]()
+			{
+				const int32 Due = ConnectRate > 0.f ? FMath::Min(NumClients, FMath::CeilToInt((FPlatformTime::Seconds() - Phase.StartSeconds) * ConnectRate)) : NumClients;
+				while (NumOpened < Due)
+				{
+					OpenClient(NumOpened++);
+				}
+				return NumConnected + NumErrors >= NumClients;
+			}, Timeout);
+		Phase.Report(TEXT("Connect"), NumConnected, TEXT("connects"), ConnectLatency);
+		if (!bConnected || NumErrors > 0)
+		{
+			UE_LOG(LogDSSLite, Warning, TEXT("%d/%d clients connected, %d connection errors."), NumConnected, NumClients, NumErrors);
+		}
+	}
+	const uint64 MemoryConnected = FPlatformMemory::GetStats().UsedPhysical;
+	UE_LOG(LogDSSLite, Display, TEXT("Per connection memory: %.1f KB"), MemoryConnected > MemoryBefore ? (MemoryConnected - MemoryBefore) / 1024.0 / FMath::Max(1, NumConnected) : 0.0);
+
+	// travel storm, every connected client keeps one request in flight
+	{
+		const FLoadPhase Phase;
+		const int32 NumTravels = NumConnected * TravelsPerClient;
+		PumpUntil([&]()
+			{
+				const double Now = FPlatformTime::Seconds();
+				for (int32 Index = 0; Index < NumClients; ++Index)
+				{
+					const FLoadClient& Client = Clients[Index];
+					if (Client.bConnected && !Client.bWaiting && Client.TravelsSent < TravelsPerClient && Now >= Client.NextTravelTime)
+					{
+						SendTravel(Index);
+					}
+				}
+				return NumTravelsDone >= NumTravels;
+			}, Timeout);
+		Phase.Report(TEXT("Travel"), NumTravelsDone, TEXT("travels"), TravelLatency);
+		if (NumTravelsDone < NumTravels)
+		{
+			UE_LOG(LogDSSLite, Warning, TEXT("%d/%d travels answered, %d sent."), NumTravelsDone, NumTravels, NumTravelsSent);
+		}
+	}
+
+	for (const FLoadClient& Client : Clients)
+	{
+		if (Client.Hub.IsValid())
+		{
+			Client.Hub->Stop();
+		}
+	}
+	PumpUntil([&]()
+		{
+			return !Clients.ContainsByPredicate([](const FLoadClient& Client) { return Client.Hub.IsValid() && Client.Hub->IsConnected(); });
+		}, 10.0);
+	return NumConnected == NumClients ? 0 : 1;
+}
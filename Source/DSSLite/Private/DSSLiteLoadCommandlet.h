@@ -0,0 +1,25 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DSSLiteLoadCommandlet.generated.h"
+
+/*
+* Load generator, opens Clients connections to /ClientsHub from one process, each with its own client token,
+* and runs a weighted mix of travel requests. Reports connects/s, travels/s, latency percentiles, CPU and memory.
+* -run=DSSLiteLoad -Host=127.0.0.1:5000 -SigningKey=Key -Clients=1000 -ConnectRate=0 -Travels=10 -ThinkMs=0
+*                  -Mix=Travel:1,TravelWithTag:0,TravelWithCoordinates:0 -Maps=Lobby -Tag=Spawn -Seed=0 -Timeout=120
+* -Scenario=Scenario.json runs against a local FDSSEmulator instead of -Host.
+*/
+UCLASS()
+class UDSSLiteLoadCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDSSLiteLoadCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteLoopbackCommandlet.h"
+#include "DSSLiteModule.h"
+#include "LoopbackSignalRServer.h"
+#include "DSSLiteCommandletUtils.h"
+
+using DSSLiteCommandlet::PumpUntil;
+
+UDSSLiteLoopbackCommandlet::UDSSLiteLoopbackCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDSSLiteLoopbackCommandlet::Main(const FString& Params)
+{
+	int32 NumClients = 16;
+	int32 NumInvokes = 1000;
+	int32 NumReconnects = 5;
+	float LatencyMs = 0.f;
+	float JitterMs = 0.f;
+	float LossRate = 0.f;
+	double Timeout = 60.0;
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("Invokes="), NumInvokes);
+	FParse::Value(*Params, TEXT("Reconnects="), NumReconnects);
+	FParse::Value(*Params, TEXT("LatencyMs="), LatencyMs);
+	FParse::Value(*Params, TEXT("JitterMs="), JitterMs);
+	FParse::Value(*Params, TEXT("Loss="), LossRate);
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+	NumClients = FMath::Max(1, NumClients);
+
+	TSharedRef<FLoopbackSignalRServer> Server = FLoopbackSignalRServer::Create(TEXT("DSSLiteLoopbackCommandlet"));
+	Server->SetLatency(LatencyMs, JitterMs);
+	Server->SetLossRate(LossRate);
+	Server->On(TEXT("Echo")).BindLambda([](int32 ClientId, const TArray<FSignalRValue>& Arguments)
+		{
+			return Arguments.Num() > 0 ? Arguments[0] : FSignalRValue();
+		});
+
+	TArray<TSharedPtr<IHubConnection>> Hubs;
+	TArray<double> ConnectTimes;
+	ConnectTimes.Init(0.0, NumClients);
+	int32 NumConnected = 0;
+
+	// connect latency
+	const double ConnectStart = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		TSharedPtr<IHubConnection> Hub = FDSSLiteModule::Get().CreateHubConnection(Server->GetUrl(TEXT("/LoopbackHub")), TEXT("loopback"));
+		Hub->OnConnected().AddLambda([&ConnectTimes, &NumConnected, Index, ConnectStart]()
+			{
+				if (ConnectTimes[Index] == 0.0)
+				{
+					ConnectTimes[Index] = FPlatformTime::Seconds() - ConnectStart;
+				}
+				++NumConnected;
+			});
+		Hub->Start();
+		Hubs.Add(Hub);
+	}
+
+	if (!PumpUntil([&]() { return NumConnected == NumClients; }, Timeout))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Only %d/%d clients connected before the timeout."), NumConnected, NumClients);
+		return 1;
+	}
+	ConnectTimes.Sort();
+	UE_LOG(LogDSSLite, Display, TEXT("Connect: %d clients, p50 %.3f ms, max %.3f ms, total %.3f ms"), NumClients, ConnectTimes[NumClients / 2] * 1000.0, ConnectTimes.Last() * 1000.0, (FPlatformTime::Seconds() - ConnectStart) * 1000.0);
+
+	// invoke throughput, lost frames never complete so only count what came back
+	int32 NumCompleted = 0;
+	const double InvokeStart = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumInvokes; ++Index)
+	{
+		Hubs[Index % NumClients]->Invoke(TEXT("Echo"), Index).BindLambda([&NumCompleted](const FSignalRValue& Result)
+			{
+				++NumCompleted;
+			});
+	}
+	PumpUntil([&]() { return NumCompleted == NumInvokes; }, Timeout);
+	const double InvokeElapsed = FPlatformTime::Seconds() - InvokeStart;
+	UE_LOG(LogDSSLite, Display, TEXT("Invoke: %d/%d completed in %.3f ms, %.0f invokes/s"), NumCompleted, NumInvokes, InvokeElapsed * 1000.0, InvokeElapsed > 0 ? NumCompleted / InvokeElapsed : 0.0);
+
+	// server initiated close with allowReconnect
+	for (int32 Round = 0; Round < NumReconnects; ++Round)
+	{
+		NumConnected = 0;
+		const double ReconnectStart = FPlatformTime::Seconds();
+		Server->CloseAll(FString(), true);
+		if (!PumpUntil([&]() { return NumConnected == NumClients; }, Timeout))
+		{
+			UE_LOG(LogDSSLite, Error, TEXT("Only %d/%d clients reconnected before the timeout."), NumConnected, NumClients);
+			return 1;
+		}
+		UE_LOG(LogDSSLite, Display, TEXT("Reconnect %d: %d clients in %.3f ms"), Round + 1, NumClients, (FPlatformTime::Seconds() - ReconnectStart) * 1000.0);
+	}
+
+	for (const TSharedPtr<IHubConnection>& Hub : Hubs)
+	{
+		Hub->Stop();
+	}
+	PumpUntil([&]() { return Server->GetNumClients() == 0; }, Timeout);
+	return 0;
+}
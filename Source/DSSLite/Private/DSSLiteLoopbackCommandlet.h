@@ -0,0 +1,22 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DSSLiteLoopbackCommandlet.generated.h"
+
+/*
+* Benchmarks the hub connection stack against FLoopbackSignalRServer.
+* -run=DSSLiteLoopback -Clients=16 -Invokes=1000 -Reconnects=5 -LatencyMs=0 -JitterMs=0 -Loss=0 -Timeout=60
+*/
+UCLASS()
+class UDSSLiteLoopbackCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDSSLiteLoopbackCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
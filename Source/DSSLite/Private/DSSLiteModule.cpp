@@ -4,10 +4,31 @@
 #include "Modules/ModuleManager.h"
 #include "WebSocketsModule.h"
 #include "Engine/Engine.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+#include "DSSLiteTokens.h"
 #include "../ThirdParty/SignalR/Private/HubConnection.h"
+#include "DSSLiteStats.h"
+#include "DSSLiteTrace.h"
 
 
 DEFINE_LOG_CATEGORY(LogDSSLite);
+
+DEFINE_STAT(STAT_DSSLite_Parse);
+DEFINE_STAT(STAT_DSSLite_Serialize);
+DEFINE_STAT(STAT_DSSLite_BytesIn);
+DEFINE_STAT(STAT_DSSLite_BytesOut);
+DEFINE_STAT(STAT_DSSLite_FramesIn);
+DEFINE_STAT(STAT_DSSLite_FramesOut);
+DEFINE_STAT(STAT_DSSLite_RecordsIn);
+DEFINE_STAT(STAT_DSSLite_RecordsPerFrame);
+DEFINE_STAT(STAT_DSSLite_QueueDepth);
+DEFINE_STAT(STAT_DSSLite_PendingInvocations);
+DEFINE_STAT(STAT_DSSLite_Reconnects);
+DEFINE_STAT(STAT_DSSLite_InvokeRTT);
+
+UE_TRACE_CHANNEL_DEFINE(DSSLiteChannel);
 #define LOCTEXT_NAMESPACE "FDSSLiteModule"
 
 FDSSLiteModule* FDSSLiteModule::Singleton = nullptr;
@@ -29,18 +50,89 @@ void FDSSLiteModule::StartupModule()
     Singleton = this;
     bInitialized = true;
     FModuleManager::LoadModuleChecked<FWebSocketsModule>("WebSockets");
+    StartServerHub();
 }
 
 void FDSSLiteModule::ShutdownModule()
 {
+    if (ServerHub.IsValid())
+    {
+        ServerHub->Stop();
+        ServerHub.Reset();
+    }
     bInitialized = false;
 	
 }
 
+void FDSSLiteModule::StartServerHub()
+{
+    // PIE servers and commandlets keep connecting from the subsystem
+    if (!IsRunningDedicatedServer() || GIsEditor || IsRunningCommandlet())
+        return;
+
+    // missing arguments are reported by the subsystem
+    int32 DSSPort = 0;
+    FString AuthKey;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("DSSPort"), DSSPort) || !FParse::Value(FCommandLine::Get(), TEXT("AuthKey"), AuthKey))
+        return;
+
+    // no world yet, resolve the listen port the way FURL does
+    ServerHubPort = 7777;
+    GConfig->GetInt(TEXT("URL"), TEXT("Port"), ServerHubPort, GEngineIni);
+    FParse::Value(FCommandLine::Get(), TEXT("Port="), ServerHubPort);
+
+    const FString Url = FString::Printf(TEXT("http://127.0.0.1:%d/ServersHub"), DSSPort);
+    UE_LOG(LogDSSLite, Display, TEXT("Connecting to=%s at startup"), *Url);
+    ServerHub = CreateHubConnection(Url, DSSLiteTokens::CreateServerToken(ServerHubPort, AuthKey, AuthKey, 60));
+    ServerHub->On(TEXT("OnConnect")).BindLambda([this](const TArray<FSignalRValue>& Arguments)
+        {
+            ServerHubOnConnectArguments = Arguments;
+        });
+    ServerHub->Start();
+}
+
+TSharedPtr<IHubConnection> FDSSLiteModule::AdoptServerHub(int32 InServerPort, TArray<FSignalRValue>& OutOnConnectArguments)
+{
+    TSharedPtr<IHubConnection> Hub = MoveTemp(ServerHub);
+    ServerHub.Reset();
+    if (Hub.IsValid() && InServerPort != ServerHubPort)
+    {
+        UE_LOG(LogDSSLite, Warning, TEXT("Startup connection was signed for port %d, server listens on %d, reconnecting."), ServerHubPort, InServerPort);
+        Hub->Stop();
+        Hub.Reset();
+    }
+    else if (Hub.IsValid() && !Hub->IsConnected() && !Hub->IsConnecting())
+    {
+        UE_LOG(LogDSSLite, Warning, TEXT("Startup connection failed or was closed, reconnecting."));
+        Hub.Reset();
+    }
+    if (Hub.IsValid())
+    {
+        // the subsystem binds its own OnConnect handler
+        Hub->Off(TEXT("OnConnect"));
+    }
+    OutOnConnectArguments = MoveTemp(ServerHubOnConnectArguments);
+    ServerHubOnConnectArguments.Reset();
+    return Hub;
+}
+
 TSharedPtr<IHubConnection> FDSSLiteModule::CreateHubConnection(const FString& InUrl, const FString& InToken, const TMap<FString, FString>& InHeaders)
 {
     check(bInitialized);
-    return MakeShared<FHubConnection>(InUrl, InToken, InHeaders);
+    TSharedPtr<IHubConnection> Hub = MakeShared<FHubConnection>(InUrl, InToken, InHeaders);
+
+    FString RecordFilename;
+    if (FParse::Value(FCommandLine::Get(), TEXT("DSSRecord="), RecordFilename))
+    {
+        // one log per connection, -DSSRecord=Traffic.dsslog -> Traffic.dsslog, Traffic_1.dsslog...
+        if (NumRecordedConnections > 0)
+        {
+            RecordFilename = FPaths::GetBaseFilename(RecordFilename, false) + FString::Printf(TEXT("_%d"), NumRecordedConnections) + FPaths::GetExtension(RecordFilename, true);
+        }
+        ++NumRecordedConnections;
+        Hub->StartRecording(RecordFilename);
+    }
+    return Hub;
 }
 
 #undef LOCTEXT_NAMESPACE
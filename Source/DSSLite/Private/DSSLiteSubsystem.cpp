@@ -7,16 +7,63 @@
 #include "GenericPlatform/GenericPlatformMisc.h"
 #include "Misc/CommandLine.h"
 #include "GameFramework/PlayerController.h"
-#include "../ThirdParty/jwt-cpp/jwt.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/AssetManager.h"
+#include "Engine/World.h"
+#include "UObject/UObjectGlobals.h"
+#include "Misc/PackageName.h"
+#include "Misc/EngineVersionComparison.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "AssetRegistry/AssetData.h"
+#include "TimerManager.h"
+#include "DSSLiteTokens.h"
+#include "LoopbackSignalRServer.h"
 #include <Runtime/Slate/Public/Framework/Application/SlateApplication.h>
 
 
+//options that change how the server itself runs, DSS must not pass them through AssignLevel
+static const TCHAR* ReservedAssignOptions[] = { TEXT("listen"), TEXT("game"), TEXT("port"), TEXT("restart"), TEXT("closed"), TEXT("failed") };
 
+//AssignLevel options are appended to the travel url, only ?Key=Value pairs with plain keys and values are accepted
+static bool AreAssignOptionsValid(const FString& Options)
+{
+	if (Options.IsEmpty())
+		return true;
+	if (!Options.StartsWith(TEXT("?")))
+		return false;
+
+	TArray<FString> Pairs;
+	Options.RightChop(1).ParseIntoArray(Pairs, TEXT("?"), false);
+	for (const FString& Pair : Pairs)
+	{
+		FString Key, Value;
+		if (!Pair.Split(TEXT("="), &Key, &Value) || Key.IsEmpty())
+			return false;
+		for (const TCHAR Char : Key)
+		{
+			if (!FChar::IsAlnum(Char) && Char != TEXT('_'))
+				return false;
+		}
+		for (const TCHAR Char : Value)
+		{
+			if (Char == TEXT('#') || Char == TEXT('"') || FChar::IsWhitespace(Char) || Char < TEXT(' '))
+				return false;
+		}
+		for (const TCHAR* Reserved : ReservedAssignOptions)
+		{
+			if (Key.Equals(Reserved, ESearchCase::IgnoreCase))
+				return false;
+		}
+	}
+	return true;
+}
 
 
 UDSSLiteSubsystem::UDSSLiteSubsystem():
 	bIsManuallyLaunched(false),
+	bIsStandby(false),
 	bAutoClientTravel(true),
+	bPrefetchTravelMap(true),
 	bAutoServerClose(true)
 {
 
@@ -41,6 +88,7 @@ void UDSSLiteSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 			return;
 		}
 		FParse::Bool(FCommandLine::Get(), TEXT("IsManuallyLaunched"), bIsManuallyLaunched);
+		FParse::Bool(FCommandLine::Get(), TEXT("DSSStandby"), bIsStandby);
 		FString AuthenticationKey;
 		if (FParse::Value(FCommandLine::Get(), TEXT("AuthKey"), AuthenticationKey))
 		{
@@ -52,46 +100,52 @@ void UDSSLiteSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 			FGenericPlatformMisc::RequestExit(false);
 			return;
 		}
-		jwt::builder<jwt::picojson_traits> JwtGenerator = jwt::create();
-		
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("port")), jwt::claim(std::string(TCHAR_TO_ANSI(*FString::FromInt(GetServerPort())))));
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("role")), jwt::claim(std::string(TCHAR_TO_ANSI(*FString("server")))));
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("key")), jwt::claim(std::string(TCHAR_TO_ANSI(*AuthenticationKey))));
-		JwtGenerator.set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds{ 60 });//expire after 60 sec
-
-		FString token = FString(UTF8_TO_TCHAR(JwtGenerator.sign(jwt::algorithm::hs256{ TCHAR_TO_ANSI(*AuthenticationKey) }).c_str()));
-		UE_LOG(LogDSSLite, Display, TEXT("Token=%s"),*token);
-		FString ConnString= FString::Printf(TEXT("http://127.0.0.1:%s"), *FString::FromInt(DSSPort));
-		UE_LOG(LogDSSLite, Display, TEXT("Connecting to=%s"), *ConnString);
-		ConnectWithToken(ConnString, token);
+		PlayerTokens = MakeShared<DSSLiteTokens::FClientTokenVerifier>(AuthenticationKey);//players are signed with the same key
+		TArray<FSignalRValue> OnConnectArguments;
+		Hub = FDSSLiteModule::Get().AdoptServerHub(GetServerPort(), OnConnectArguments);
+		if (Hub.IsValid())
+		{
+			//connecting since StartupModule
+			UE_LOG(LogDSSLite, Display, TEXT("Adopted the DSS connection started at module startup."));
+			BindHub();
+			if (Hub->IsConnected())
+				Connected();
+			if (OnConnectArguments.Num() > 0)
+				ReceiveOnConnect(OnConnectArguments);
+		}
+		else
+		{
+			FString ConnString = FString::Printf(TEXT("http://127.0.0.1:%s"), *FString::FromInt(DSSPort));
+			ConnectWithServerToken(ConnString, AuthenticationKey);//expire after 60 sec
+		}
 		
 
 	}
 	else if (GetGameInstance()->IsDedicatedServerInstance() && (GetWorld()->IsPlayInEditor() ||  GetWorld()->IsPlayInPreview()))
 	{
 		//testing in editor
-		jwt::builder<jwt::picojson_traits> JwtGenerator = jwt::create();
-
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("port")), jwt::claim(std::string(TCHAR_TO_ANSI(*FString::FromInt(GetServerPort())))));
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("role")), jwt::claim(std::string(TCHAR_TO_ANSI(*FString("server")))));
-		JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("key")), jwt::claim(std::string("0000000000")));//no need for authorization
-		JwtGenerator.set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds{ 60 });//expire after 60 sec
-
-		FString token = FString(UTF8_TO_TCHAR(JwtGenerator.sign(jwt::algorithm::hs256{ "0000000000" }).c_str()));
-		UE_LOG(LogDSSLite, Display, TEXT("Token=%s"), *token);
+		PlayerTokens = MakeShared<DSSLiteTokens::FClientTokenVerifier>(TEXT("0000000000"));
 		FString ConnString = FString::Printf(TEXT("http://127.0.0.1:%s"), *FString::FromInt(DSSPort));
-		UE_LOG(LogDSSLite, Display, TEXT("Connecting to=%s"), *ConnString);
-		ConnectWithToken(ConnString, token);
+		ConnectWithServerToken(ConnString, TEXT("0000000000"));//no need for authorization, expire after 60 sec
+		HandleMapLoaded(GetWorld());//PIE worlds exist before the game instance
 	}
 	else
 	{
 		
 	}
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::HandleMapLoaded);
 }
 
 void UDSSLiteSubsystem::Deinitialize()
 {
-
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	if (WarmUpHandle.IsValid())
+	{
+		WarmUpHandle->CancelHandle();
+		WarmUpHandle.Reset();
+	}
+	ReleaseTravelMap();
 }
 
 void UDSSLiteSubsystem::ConnectWithToken(FString Connection, FString Token) {
@@ -102,58 +156,66 @@ void UDSSLiteSubsystem::ConnectWithToken(FString Connection, FString Token) {
 	if(GetGameInstance()->IsDedicatedServerInstance())
 		Connection.Append(TEXT("/ServersHub"));
 	else
+	{
 		Connection.Append(TEXT("/ClientsHub"));
-	if (!Connection.ToLower().StartsWith("http"))
+		ClientToken = Token;
+	}
+	if (!Connection.ToLower().StartsWith("http") && !Connection.StartsWith(FLoopbackSignalRServer::Scheme))
 		Connection = "http://" + Connection;
 	Hub = FDSSLiteModule::Get().CreateHubConnection(Connection, Token);
 	Hub->Start();
+	BindHub();
+}
+
+void UDSSLiteSubsystem::BindHub()
+{
 	Hub->OnConnectionError().AddUObject(this, &ThisClass::ConnectionError);
 	Hub->OnConnected().AddUObject(this, &UDSSLiteSubsystem::Connected);
-	
-	
-	Hub->On(TEXT("OnConnect")).BindLambda([&](const TArray<FSignalRValue>& Arguments) 
-		{
-			FDateTime Timestamp= FDateTime::Now();
-			bool bDateTimeParsed = FDateTime::Parse(Arguments[2].AsString(), Timestamp);
-			ClientID = Arguments[0].AsString();
-			ConnectionID = Arguments[1].AsString();
-			CreatedOn = Timestamp;
-		OnConnected.Broadcast(Arguments[0].AsString(), Arguments[1].AsString(), Timestamp);
-		});
+	Hub->On(TEXT("OnConnect")).BindUObject(this, &UDSSLiteSubsystem::ReceiveOnConnect);
+}
+
+void UDSSLiteSubsystem::ReceiveOnConnect(const TArray<FSignalRValue>& Arguments)
+{
+	FDateTime Timestamp = FDateTime::Now();
+	bool bDateTimeParsed = FDateTime::Parse(Arguments[2].AsString(), Timestamp);
+	ClientID = Arguments[0].AsString();
+	ConnectionID = Arguments[1].AsString();
+	CreatedOn = Timestamp;
+	OnConnected.Broadcast(ClientID, ConnectionID, Timestamp);
 }
 
 void UDSSLiteSubsystem::Connect(FString Connection, FString PlayerName, FString SigningKey) {
 
-	if (IsConnected())
+	if (IsConnected() || bSigningToken)
 		return;//already connected
 	if (GetGameInstance()->IsDedicatedServerInstance())
 		return;//callable on clients only, i don't advice to use it
-	
-	Connection.Append(TEXT("/ClientsHub"));
-	if (!Connection.ToLower().StartsWith("http"))
-		Connection = "http://" + Connection;///make sure ip contains http
-
-	jwt::builder<jwt::picojson_traits> JwtGenerator = jwt::create();
-	JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("name")), jwt::claim(std::string(TCHAR_TO_ANSI(*PlayerName))));
-	JwtGenerator.set_payload_claim(TCHAR_TO_ANSI(*FString("role")), jwt::claim(std::string(TCHAR_TO_ANSI(*FString("client")))));
-	JwtGenerator.set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds{ 60 });//expire after 60 sec
-	FString Token = FString(UTF8_TO_TCHAR(JwtGenerator.sign(jwt::algorithm::hs256{ TCHAR_TO_ANSI(*SigningKey) }).c_str()));
-
-
-	Hub = FDSSLiteModule::Get().CreateHubConnection(Connection, Token);
-	Hub->Start();
-	Hub->OnConnectionError().AddUObject(this, &ThisClass::ConnectionError);
-	Hub->OnConnected().AddUObject(this, &UDSSLiteSubsystem::Connected);
 
+	TravelSigningKey = SigningKey;
+	bSigningToken = true;
+	TWeakObjectPtr<UDSSLiteSubsystem> WeakThis(this);
+	DSSLiteTokens::CreateClientTokenAsync(PlayerName, SigningKey, 60, [WeakThis, Connection](const FString& Token)//expire after 60 sec
+		{
+			if (!WeakThis.IsValid())
+				return;
+			WeakThis->bSigningToken = false;
+			WeakThis->ConnectWithToken(Connection, Token);
+		});
+}
 
-	Hub->On(TEXT("OnConnect")).BindLambda([&](const TArray<FSignalRValue>& Arguments)
+void UDSSLiteSubsystem::ConnectWithServerToken(const FString& Connection, const FString& AuthenticationKey)
+{
+	UE_LOG(LogDSSLite, Display, TEXT("Connecting to=%s"), *Connection);
+	//signed on a worker while the world finishes starting up
+	bSigningToken = true;
+	TWeakObjectPtr<UDSSLiteSubsystem> WeakThis(this);
+	DSSLiteTokens::CreateServerTokenAsync(GetServerPort(), AuthenticationKey, AuthenticationKey, 60, [WeakThis, Connection](const FString& Token)
 		{
-			FDateTime Timestamp = FDateTime::Now();
-			bool bDateTimeParsed = FDateTime::Parse(Arguments[2].AsString(), Timestamp);
-			ClientID = Arguments[0].AsString();
-			ConnectionID = Arguments[1].AsString();
-			CreatedOn = Timestamp;
-			OnConnected.Broadcast(Arguments[0].AsString(), Arguments[1].AsString(), Timestamp);
+			if (!WeakThis.IsValid())
+				return;
+			UE_LOG(LogDSSLite, Display, TEXT("Token=%s"), *Token);
+			WeakThis->bSigningToken = false;
+			WeakThis->ConnectWithToken(Connection, Token);
 		});
 }
 
@@ -172,6 +234,10 @@ void UDSSLiteSubsystem::TravelAsync(FString MapName, bool bIsDungeon, FString In
 	default:
 		break;
 	}
+
+	//server side travel moves another player, only clients load the target map
+	if (bPrefetchTravelMap && !GetGameInstance()->IsDedicatedServerInstance())
+		PrefetchTravelMap(MapName);
 	
 	if (bIsDungeon)
 	{
@@ -201,8 +267,221 @@ void UDSSLiteSubsystem::Disconnect()
 	Hub->Stop();
 }
 
+FDSSConnectionStats UDSSLiteSubsystem::GetConnectionStats() const
+{
+	FDSSConnectionStats Stats;
+	if (Hub == nullptr)
+		return Stats;
+
+	const FHubConnectionStats HubStats = Hub->GetStats();
+	Stats.BytesIn = HubStats.BytesIn;
+	Stats.BytesOut = HubStats.BytesOut;
+	Stats.FramesIn = HubStats.FramesIn;
+	Stats.FramesOut = HubStats.FramesOut;
+	Stats.RecordsIn = HubStats.RecordsIn;
+	Stats.RecordsPerFrame = HubStats.RecordsPerFrame;
+	Stats.ParseTimeMs = HubStats.ParseTimeSeconds * 1000.0;
+	Stats.SerializeTimeMs = HubStats.SerializeTimeSeconds * 1000.0;
+	Stats.QueueDepth = HubStats.QueueDepth;
+	Stats.PendingInvocations = HubStats.PendingInvocations;
+	Stats.ReconnectCount = HubStats.ReconnectCount;
+	Stats.InvokeRTTMs = HubStats.InvokeRTTSeconds < 0 ? -1.f : HubStats.InvokeRTTSeconds * 1000.0;
+	return Stats;
+}
+
+void UDSSLiteSubsystem::SetServerState(EDSSServerState State)
+{
+	if (!GetGameInstance()->IsDedicatedServerInstance() || State == ServerState)
+		return;
+	ServerState = State;
+	UE_LOG(LogDSSLite, Display, TEXT("Server state %s."), *StaticEnum<EDSSServerState>()->GetNameStringByValue((int64)State));
+	SendServerState();
+	OnServerStateChanged.Broadcast(State);
+}
+
+void UDSSLiteSubsystem::SendServerState()
+{
+	if (IsConnected())
+		Hub->Send(TEXT("ServerState"), (int32)ServerState);
+}
+
+void UDSSLiteSubsystem::HandleMapLoaded(UWorld* World)
+{
+	if (World == nullptr || World->GetGameInstance() != GetGameInstance())
+		return;
+
+	// the travel ended, the new world holds its own references
+	if (!GetGameInstance()->IsDedicatedServerInstance())
+	{
+		ReleaseTravelMap();
+		return;
+	}
+
+	if (ServerState == EDSSServerState::Draining)
+		return;
+
+	// a new map restarts the warm up
+	if (WarmUpHandle.IsValid())
+	{
+		WarmUpHandle->CancelHandle();
+		WarmUpHandle.Reset();
+	}
+	ServerState = EDSSServerState::Booting;
+	SetServerState(EDSSServerState::MapLoaded);
+	if (World->HasBegunPlay())
+		HandleWorldBeginPlay();
+	else
+		World->OnWorldBeginPlay.AddUObject(this, &ThisClass::HandleWorldBeginPlay);
+}
+
+void UDSSLiteSubsystem::HandleWorldBeginPlay()
+{
+	if (ServerState != EDSSServerState::MapLoaded || WarmUpHandle.IsValid())
+		return;
+
+	// the standby map takes no players, warm up is for the assigned level
+	if (bIsStandby)
+	{
+		SetServerState(EDSSServerState::Standby);
+		return;
+	}
+
+	if (WarmUpAssets.Num() > 0)
+	{
+		UE_LOG(LogDSSLite, Display, TEXT("Warming up %d assets."), WarmUpAssets.Num());
+		WarmUpHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(WarmUpAssets, FStreamableDelegate::CreateUObject(this, &ThisClass::HandleWarmUpLoaded));
+		if (WarmUpHandle.IsValid())
+			return;
+	}
+	SetServerState(EDSSServerState::Warm);
+}
+
+void UDSSLiteSubsystem::HandleWarmUpLoaded()
+{
+	if (ServerState == EDSSServerState::MapLoaded)
+		SetServerState(EDSSServerState::Warm);
+}
+
+void UDSSLiteSubsystem::HandleAssignLevel(const TArray<FSignalRValue>& Arguments)
+{
+	if (!bIsStandby || ServerState != EDSSServerState::Standby)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("AssignLevel ignored, the server is not waiting on standby."));
+		return;
+	}
+
+	//MapName, then optional url options
+	const FString MapName = Arguments.Num() > 0 ? Arguments[0].AsString() : FString();
+	const FString Options = Arguments.Num() > 1 ? Arguments[1].AsString() : FString();
+	if (!MapName.StartsWith(TEXT("/Game/")) || !FPackageName::DoesPackageExist(MapName))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("AssignLevel map %s does not exist."), *MapName);
+		return;
+	}
+	if (!AreAssignOptionsValid(Options))
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("AssignLevel options %s rejected, expected ?Key=Value pairs."), *Options);
+		return;
+	}
+
+	UE_LOG(LogDSSLite, Display, TEXT("Assigned level %s, traveling."), *MapName);
+	bIsStandby = false;
+	SetServerState(EDSSServerState::Booting);
+	OnLevelAssigned.Broadcast(MapName);
+	//MapLoaded and Warm follow from the new world like on a cold boot
+	GetGameInstance()->GetWorld()->ServerTravel(MapName + Options, true);
+}
+
+bool UDSSLiteSubsystem::FindMapPackage(const FString& MapName, FString& OutPackageName) const
+{
+	IAssetRegistry* AssetRegistry = IAssetRegistry::Get();
+	if (AssetRegistry == nullptr)
+		return false;
+
+	//in memory query, the registry is still scanning in the editor and may miss maps there
+	FARFilter Filter;
+#if UE_VERSION_OLDER_THAN(5, 1, 0)
+	Filter.ClassNames.Add(UWorld::StaticClass()->GetFName());
+#else
+	Filter.ClassPaths.Add(UWorld::StaticClass()->GetClassPathName());
+#endif
+	Filter.PackagePaths.Add(TEXT("/Game"));
+	Filter.bRecursivePaths = true;
+	TArray<FAssetData> Worlds;
+	AssetRegistry->GetAssets(Filter, Worlds);
+
+	const FName ShortName(*FPackageName::GetShortName(MapName));
+	for (const FAssetData& World : Worlds)
+	{
+		if (World.AssetName == ShortName)
+		{
+			OutPackageName = World.PackageName.ToString();
+			return true;
+		}
+	}
+	return false;
+}
+
+void UDSSLiteSubsystem::PrefetchTravelMap(const FString& MapName)
+{
+	//MapName may be a short name, DSS resolves both. Short names are looked up in the asset registry, never on disk
+	FString PackageName = MapName;
+	if (!FPackageName::IsValidLongPackageName(PackageName) && !FindMapPackage(MapName, PackageName))
+	{
+		UE_LOG(LogDSSLite, Verbose, TEXT("No package found for travel map %s, skipping prefetch."), *MapName);
+		return;
+	}
+
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World != nullptr && World->GetOutermost()->GetName() == PackageName)
+		return;//already there, nothing to load
+
+	ReleaseTravelMap();
+	UE_LOG(LogDSSLite, Display, TEXT("Prefetching travel map %s."), *PackageName);
+	TravelMapHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(FSoftObjectPath(PackageName + TEXT(".") + FPackageName::GetShortName(PackageName)));
+	//DSS may never answer, do not pin the map forever
+	GetGameInstance()->GetTimerManager().SetTimer(TravelMapTimer, FTimerDelegate::CreateUObject(this, &ThisClass::ReleaseTravelMap), 60.f, false);
+}
+
+void UDSSLiteSubsystem::ReleaseTravelMap()
+{
+	if (GetGameInstance() != nullptr)
+		GetGameInstance()->GetTimerManager().ClearTimer(TravelMapTimer);
+	if (TravelMapHandle.IsValid())
+	{
+		TravelMapHandle->ReleaseHandle();
+		TravelMapHandle.Reset();
+	}
+}
+
+bool UDSSLiteSubsystem::VerifyPlayerToken(const FString& Token, FString& PlayerName)
+{
+	if (!PlayerTokens.IsValid())
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("VerifyPlayerToken is only available on DSS launched servers."));
+		return false;
+	}
+	return PlayerTokens->Verify(Token, PlayerName);
+}
+
+bool UDSSLiteSubsystem::VerifyPlayerLogin(const FString& Options, FString& PlayerName)
+{
+	const FString Token = UGameplayStatics::ParseOption(Options, TEXT("DSSToken"));
+	if (Token.IsEmpty() || !VerifyPlayerToken(Token, PlayerName))
+		return false;
+
+	const FString RequestedName = UGameplayStatics::ParseOption(Options, TEXT("PlayerName"));
+	if (!RequestedName.IsEmpty() && !RequestedName.Equals(PlayerName, ESearchCase::CaseSensitive))
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Login as %s rejected, token was issued to %s."), *RequestedName, *PlayerName);
+		return false;
+	}
+	return true;
+}
+
 void UDSSLiteSubsystem::Disconnected()
 {
+	ReleaseTravelMap();//no ClientTravel will come
 	OnDisconnected.Broadcast();
 	if(GetGameInstance()->IsDedicatedServerInstance())
 		FGenericPlatformMisc::RequestExit(false);
@@ -220,8 +499,10 @@ void UDSSLiteSubsystem::Connected()
 
 	if (GetGameInstance()->IsDedicatedServerInstance())
 	{
+		SendServerState();//DSS routes players once it reads Warm
 		Hub->On(TEXT("ServerClose")).BindLambda([&](const TArray<FSignalRValue>& Arguments)
 			{
+				SetServerState(EDSSServerState::Draining);
 				ServerTerminate.Broadcast();
 				if(bAutoServerClose)
 				{
@@ -231,6 +512,8 @@ void UDSSLiteSubsystem::Connected()
 				}
 			});
 		
+		Hub->On(TEXT("AssignLevel")).BindUObject(this, &UDSSLiteSubsystem::HandleAssignLevel);
+
 		Hub->On(TEXT("PlayerDisconnected")).BindLambda([&](const TArray<FSignalRValue>& Arguments)
 			{
 				FString PlayerName = Arguments[0].AsString();
@@ -243,19 +526,27 @@ void UDSSLiteSubsystem::Connected()
 			{
 				ShowLoadingScreen.Broadcast();
 				TravelOptions Options = (TravelOptions)Arguments[4].AsInt();
+				//arguments may borrow from the inbound frame, promote each string once
+				const FString Address = Arguments[0].AsString();
+				const int32 Port = Arguments[1].AsInt();
+				const FString PlayerName = Arguments[2].AsString();
+				const FString ServerConnectionID = Arguments[3].AsString();
 				FString UrlOptions;
 				switch (Options)
 				{
 				case TravelOptions::NONE:
-					OnTravel.Broadcast(Arguments[0].AsString(), Arguments[1].AsInt(), Arguments[2].AsString(), Arguments[3].AsString(), Options,"", FVector(0.f, 0.f, 0.f),-1.f);
+					OnTravel.Broadcast(Address, Port, PlayerName, ServerConnectionID, Options,"", FVector(0.f, 0.f, 0.f),-1.f);
 					UrlOptions = "?mode=0";
 					break;
 				case TravelOptions::TAG:
-					OnTravel.Broadcast(Arguments[0].AsString(), Arguments[1].AsInt(), Arguments[2].AsString(), Arguments[3].AsString(),Options, Arguments[5].AsString(), FVector(0.f, 0.f, 0.f), -1.f);
-					UrlOptions = "?mode=1#"+ Arguments[5].AsString();
+				{
+					const FString Tag = Arguments[5].AsString();
+					OnTravel.Broadcast(Address, Port, PlayerName, ServerConnectionID,Options, Tag, FVector(0.f, 0.f, 0.f), -1.f);
+					UrlOptions = "?mode=1#"+ Tag;
 					break;
+				}
 				case TravelOptions::COORDINATES:
-					OnTravel.Broadcast(Arguments[0].AsString(), Arguments[1].AsInt(), Arguments[2].AsString(), Arguments[3].AsString(), Options,"",FVector(Arguments[5].AsFloat(), Arguments[6].AsFloat(), Arguments[7].AsFloat()), Arguments[8].AsFloat());
+					OnTravel.Broadcast(Address, Port, PlayerName, ServerConnectionID, Options,"",FVector(Arguments[5].AsFloat(), Arguments[6].AsFloat(), Arguments[7].AsFloat()), Arguments[8].AsFloat());
 					UrlOptions = FString::Printf(TEXT("?mode=2?Location=X=%f,Y=%f,Z=%f?Rotation=%f"), Arguments[5].AsFloat(), Arguments[6].AsFloat(), Arguments[7].AsFloat(), Arguments[8].AsFloat());
 					break;
 				default:
@@ -264,19 +555,46 @@ void UDSSLiteSubsystem::Connected()
 				
 				if(bAutoClientTravel)
 				{
-
-					const FString Command = FString::Printf(TEXT("Travel %s:%d?PlayerName=%s%s"), *Arguments[0].AsString(), Arguments[1].AsInt(), *Arguments[2].AsString(), *UrlOptions);
-					UE_LOG(LogDSSLite, Display, TEXT("Traveling to %s:%d, Character %s, Command %s"), *Arguments[0].AsString(), Arguments[1].AsInt(), *Arguments[2].AsString(), *Command);
-					APlayerController* TargetPC= GetGameInstance()->GetWorld()->GetFirstPlayerController();
-					if (TargetPC != nullptr) 
-					{
-						TargetPC->ConsoleCommand(*Command, true);
-					}
-					else
+					//the command carries the DSSToken, only the destination is logged
+					UE_LOG(LogDSSLite, Display, TEXT("Traveling to %s:%d, Character %s, Options %s"), *Address, Port, *PlayerName, *UrlOptions);
+					if (TravelSigningKey.IsEmpty())
 					{
-						GEngine->Exec(GetGameInstance()->GetWorld(), *Command);
+						//ConnectWithToken cannot sign again, VerifyPlayerLogin would reject an expired token on the server
+						FDateTime Expiry;
+						if (DSSLiteTokens::GetExpiry(ClientToken, Expiry) && Expiry <= FDateTime::UtcNow())
+						{
+							const FString Error = FString::Printf(TEXT("Cannot travel to %s:%d, the client token expired at %s. Disconnect and connect again with a fresh token"), *Address, Port, *Expiry.ToIso8601());
+							UE_LOG(LogDSSLite, Error, TEXT("%s"), *Error);
+							OnConnectionError.Broadcast(Error);
+							return;
+						}
+						ExecuteTravel(Address, Port, PlayerName, ClientToken, UrlOptions);
+						return;
 					}
+
+					//signed again on a worker so the token does not expire on the way
+					TWeakObjectPtr<UDSSLiteSubsystem> WeakThis(this);
+					DSSLiteTokens::CreateClientTokenAsync(PlayerName, TravelSigningKey, 60, [WeakThis, Address, Port, PlayerName, UrlOptions](const FString& Token)
+						{
+							if (!WeakThis.IsValid())
+								return;
+							WeakThis->ExecuteTravel(Address, Port, PlayerName, Token, UrlOptions);
+						});
 				}
 			});
 	}
 }
+
+void UDSSLiteSubsystem::ExecuteTravel(const FString& Address, int32 Port, const FString& PlayerName, const FString& TravelToken, const FString& UrlOptions)
+{
+	const FString Command = FString::Printf(TEXT("Travel %s:%d?PlayerName=%s?DSSToken=%s%s"), *Address, Port, *PlayerName, *TravelToken, *UrlOptions);
+	APlayerController* TargetPC = GetGameInstance()->GetWorld()->GetFirstPlayerController();
+	if (TargetPC != nullptr)
+	{
+		TargetPC->ConsoleCommand(*Command, true);
+	}
+	else
+	{
+		GEngine->Exec(GetGameInstance()->GetWorld(), *Command);
+	}
+}
@@ -0,0 +1,315 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "DSSLiteTokens.h"
+#include "DSSLiteModule.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Async.h"
+#include "Misc/DateTime.h"
+#include "Hash/CityHash.h"
+#include "Containers/LruCache.h"
+#include "DSSLiteJwt.h"
+#include "DSSLiteFixedClaimToken.h"
+
+#include <unordered_map>
+
+namespace
+{
+	using FExpiry = std::chrono::system_clock::time_point;
+	using FSignerRef = TSharedRef<const jwt::algorithm::hs256, ESPMode::ThreadSafe>;
+
+	/*names and keys are signed as UTF-8, the same bytes the verifier decodes*/
+	const char* Utf8Chars(const FTCHARToUTF8& Converted)
+	{
+		return reinterpret_cast<const char*>(Converted.Get());
+	}
+
+	/*wraps the engine independent writer, the token is copied out once*/
+	bool SignFixedClaims(DSSLiteJwt::FFixedClaimToken& Token, const jwt::algorithm::hs256& Signer, FString& OutToken)
+	{
+		const char* Chars = nullptr;
+		int Length = 0;
+		if (!Token.Sign(Signer, Chars, Length))
+			return false;
+		OutToken = FString(Length, Chars);
+		return true;
+	}
+
+	/*keyed signers are reused, hashing the key into the HMAC state is most of the cost of a short token*/
+	FSignerRef GetSigner(const char* SigningKey)
+	{
+		static FCriticalSection SignersLock;
+		static std::unordered_map<std::string, FSignerRef> Signers;
+
+		FScopeLock Lock(&SignersLock);
+		auto Found = Signers.find(SigningKey);
+		if (Found != Signers.end())
+			return Found->second;
+
+		// a handful of keys is expected, do not let a misbehaving caller grow it forever
+		if (Signers.size() >= 16)
+		{
+			Signers.clear();
+		}
+		FSignerRef Signer = MakeShared<const jwt::algorithm::hs256, ESPMode::ThreadSafe>(SigningKey);
+		Signers.emplace(SigningKey, Signer);
+		return Signer;
+	}
+
+	int64 ToExp(FExpiry Expiry)
+	{
+		return (int64)std::chrono::system_clock::to_time_t(Expiry);
+	}
+
+	/*reference implementations, used when the claims do not fit the fixed buffers and to check the fast path*/
+	std::string GenericServerToken(int32 Port, const char* AuthKey, const jwt::algorithm::hs256& Signer, FExpiry Expiry)
+	{
+		return DSSLiteJwt::Create()
+			.set_payload_claim("port", DSSLiteJwt::FClaim(std::string(TCHAR_TO_ANSI(*FString::FromInt(Port)))))
+			.set_payload_claim("role", DSSLiteJwt::FClaim(std::string("server")))
+			.set_payload_claim("key", DSSLiteJwt::FClaim(std::string(AuthKey)))
+			.set_expires_at(Expiry)
+			.sign(Signer);
+	}
+
+	std::string GenericClientToken(const char* PlayerName, const jwt::algorithm::hs256& Signer, FExpiry Expiry)
+	{
+		return DSSLiteJwt::Create()
+			.set_payload_claim("name", DSSLiteJwt::FClaim(std::string(PlayerName)))
+			.set_payload_claim("role", DSSLiteJwt::FClaim(std::string("client")))
+			.set_expires_at(Expiry)
+			.sign(Signer);
+	}
+
+	FString ServerToken(int32 Port, const FString& AuthKey, const FString& SigningKey, FExpiry Expiry)
+	{
+		const FTCHARToUTF8 AuthKeyUtf8(*AuthKey);
+		const FSignerRef Signer = GetSigner(Utf8Chars(FTCHARToUTF8(*SigningKey)));
+
+		// the server reads port as a string claim
+		char PortDigits[16];
+		const int32 PortLength = FCStringAnsi::Sprintf(PortDigits, "%d", Port);
+
+		DSSLiteJwt::FFixedClaimToken Token;
+		Token.AddInteger("exp", ToExp(Expiry));
+		Token.AddString("key", Utf8Chars(AuthKeyUtf8), AuthKeyUtf8.Length());
+		Token.AddString("port", PortDigits, PortLength);
+		Token.AddString("role", "server", 6);
+
+		FString Result;
+		if (!SignFixedClaims(Token, *Signer, Result))
+		{
+			Result = UTF8_TO_TCHAR(GenericServerToken(Port, Utf8Chars(AuthKeyUtf8), *Signer, Expiry).c_str());
+		}
+		return Result;
+	}
+
+	FString ClientToken(const FString& PlayerName, const FString& SigningKey, FExpiry Expiry)
+	{
+		const FTCHARToUTF8 PlayerNameUtf8(*PlayerName);
+		const FSignerRef Signer = GetSigner(Utf8Chars(FTCHARToUTF8(*SigningKey)));
+
+		DSSLiteJwt::FFixedClaimToken Token;
+		Token.AddInteger("exp", ToExp(Expiry));
+		Token.AddString("name", Utf8Chars(PlayerNameUtf8), PlayerNameUtf8.Length());
+		Token.AddString("role", "client", 6);
+
+		FString Result;
+		if (!SignFixedClaims(Token, *Signer, Result))
+		{
+			Result = UTF8_TO_TCHAR(GenericClientToken(Utf8Chars(PlayerNameUtf8), *Signer, Expiry).c_str());
+		}
+		return Result;
+	}
+
+	void SignAsync(TUniqueFunction<FString()> Sign, TUniqueFunction<void(const FString&)> OnSigned)
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Sign = MoveTemp(Sign), OnSigned = MoveTemp(OnSigned)]() mutable
+			{
+				FString Token = Sign();
+				AsyncTask(ENamedThreads::GameThread, [Token = MoveTemp(Token), OnSigned = MoveTemp(OnSigned)]()
+					{
+						OnSigned(Token);
+					});
+			});
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithOutputDevice CheckTokensCommand(
+	TEXT("DSSLite.CheckTokens"),
+	TEXT("Compares the fixed claim token writer with jwt::builder on a set of names and keys, they must be byte-identical."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+		{
+			const FExpiry Expiry = std::chrono::system_clock::time_point(std::chrono::seconds{ 1700000000 });
+			const TArray<FString> Values = {
+				TEXT(""), TEXT("Player42"), TEXT("0000000000"), TEXT("quote\"back\\slash/"), TEXT("tab\tnew\nline\r\b\f"),
+				TEXT("ctrl\x01\x1f\x7f"), TEXT("caf\u00e9 \u4e16\u754c"), FString::ChrN(200, TEXT('x')), FString::ChrN(1000, TEXT('y')) };
+
+			int32 Checked = 0;
+			int32 Mismatches = 0;
+			for (const FString& Value : Values)
+			{
+				for (const FString& Key : { FString(TEXT("0000000000")), Value })
+				{
+					const auto Signer = GetSigner(Utf8Chars(FTCHARToUTF8(*Key)));
+					const FString ExpectedClient = UTF8_TO_TCHAR(GenericClientToken(Utf8Chars(FTCHARToUTF8(*Value)), *Signer, Expiry).c_str());
+					const FString ExpectedServer = UTF8_TO_TCHAR(GenericServerToken(7777, Utf8Chars(FTCHARToUTF8(*Value)), *Signer, Expiry).c_str());
+					for (const TPair<FString, FString>& Pair : { TPair<FString, FString>(ClientToken(Value, Key, Expiry), ExpectedClient), TPair<FString, FString>(ServerToken(7777, Value, Key, Expiry), ExpectedServer) })
+					{
+						++Checked;
+						if (!Pair.Key.Equals(Pair.Value, ESearchCase::CaseSensitive))
+						{
+							++Mismatches;
+							Ar.Logf(ELogVerbosity::Error, TEXT("Token mismatch for '%s':\n  fixed   %s\n  builder %s"), *Value.Left(32), *Pair.Key, *Pair.Value);
+						}
+					}
+				}
+			}
+			Ar.Logf(TEXT("%d/%d tokens identical"), Checked - Mismatches, Checked);
+		}));
+#endif
+
+FString DSSLiteTokens::CreateServerToken(int32 Port, const FString& AuthKey, const FString& SigningKey, int32 ExpiresInSeconds)
+{
+	return ServerToken(Port, AuthKey, SigningKey, std::chrono::system_clock::now() + std::chrono::seconds{ ExpiresInSeconds });
+}
+
+FString DSSLiteTokens::CreateClientToken(const FString& PlayerName, const FString& SigningKey, int32 ExpiresInSeconds)
+{
+	return ClientToken(PlayerName, SigningKey, std::chrono::system_clock::now() + std::chrono::seconds{ ExpiresInSeconds });
+}
+
+void DSSLiteTokens::CreateServerTokenAsync(int32 Port, const FString& AuthKey, const FString& SigningKey, int32 ExpiresInSeconds, TUniqueFunction<void(const FString&)> OnSigned)
+{
+	const FExpiry Expiry = std::chrono::system_clock::now() + std::chrono::seconds{ ExpiresInSeconds };
+	SignAsync([Port, AuthKey, SigningKey, Expiry]() { return ServerToken(Port, AuthKey, SigningKey, Expiry); }, MoveTemp(OnSigned));
+}
+
+void DSSLiteTokens::CreateClientTokenAsync(const FString& PlayerName, const FString& SigningKey, int32 ExpiresInSeconds, TUniqueFunction<void(const FString&)> OnSigned)
+{
+	const FExpiry Expiry = std::chrono::system_clock::now() + std::chrono::seconds{ ExpiresInSeconds };
+	SignAsync([PlayerName, SigningKey, Expiry]() { return ClientToken(PlayerName, SigningKey, Expiry); }, MoveTemp(OnSigned));
+}
+
+bool DSSLiteTokens::GetClaim(const FString& Token, const FString& Claim, FString& OutValue)
+{
+	try
+	{
+		const auto Decoded = DSSLiteJwt::Decode(std::string(TCHAR_TO_UTF8(*Token)));
+		const std::string ClaimName(TCHAR_TO_UTF8(*Claim));
+		if (!Decoded.has_payload_claim(ClaimName))
+			return false;
+
+		OutValue = UTF8_TO_TCHAR(Decoded.get_payload_claim(ClaimName).as_string().c_str());
+		return true;
+	}
+	catch (const std::exception& Exception)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Cannot read claim %s: %s"), *Claim, UTF8_TO_TCHAR(Exception.what()));
+		return false;
+	}
+}
+
+bool DSSLiteTokens::GetExpiry(const FString& Token, FDateTime& OutExpiry)
+{
+	try
+	{
+		const auto Decoded = DSSLiteJwt::Decode(std::string(TCHAR_TO_UTF8(*Token)));
+		if (!Decoded.has_expires_at())
+			return false;
+
+		OutExpiry = FDateTime::FromUnixTimestamp((int64)std::chrono::system_clock::to_time_t(Decoded.get_expires_at()));
+		return true;
+	}
+	catch (const std::exception& Exception)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Cannot read exp: %s"), UTF8_TO_TCHAR(Exception.what()));
+		return false;
+	}
+}
+
+struct DSSLiteTokens::FClientTokenVerifier::FImpl
+{
+	/*the whole token is kept, a hash match alone is not proof the token was verified*/
+	struct FVerifiedToken
+	{
+		FString Token;
+		FString PlayerName;
+		int64 Exp;
+	};
+
+	FImpl(const FString& SigningKey, int32 MaxCachedTokens)
+		: Verifier(DSSLiteJwt::ClientVerifier(std::string(TCHAR_TO_UTF8(*SigningKey))))
+		, Cache(MaxCachedTokens)
+	{
+	}
+
+	static uint64 HashToken(const FString& Token)
+	{
+		return CityHash64(reinterpret_cast<const char*>(*Token), Token.Len() * sizeof(TCHAR));
+	}
+
+	/*keyed once, verifyToken only copies the HMAC state*/
+	const DSSLiteJwt::FVerifier Verifier;
+
+	FCriticalSection CacheLock;
+	TLruCache<uint64, FVerifiedToken> Cache;
+};
+
+DSSLiteTokens::FClientTokenVerifier::FClientTokenVerifier(const FString& SigningKey, int32 MaxCachedTokens)
+	: Impl(MakeUnique<FImpl>(SigningKey, MaxCachedTokens))
+{
+}
+
+DSSLiteTokens::FClientTokenVerifier::~FClientTokenVerifier()
+{
+}
+
+bool DSSLiteTokens::FClientTokenVerifier::Verify(const FString& Token, FString& OutPlayerName)
+{
+	const uint64 Hash = FImpl::HashToken(Token);
+	// same bound as the verifier, a token is valid up to and including its exp second
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+	{
+		FScopeLock Lock(&Impl->CacheLock);
+		if (const FImpl::FVerifiedToken* Verified = Impl->Cache.FindAndTouch(Hash))
+		{
+			if (Verified->Token.Equals(Token, ESearchCase::CaseSensitive))
+			{
+				if (Now > Verified->Exp)
+				{
+					Impl->Cache.Remove(Hash);
+					return false;
+				}
+				OutPlayerName = Verified->PlayerName;
+				return true;
+			}
+		}
+	}
+
+	FImpl::FVerifiedToken Verified;
+	std::string PlayerName;
+	int64_t Exp = 0;
+	std::string Error;
+	if (!DSSLiteJwt::VerifyClientToken(Impl->Verifier, std::string(TCHAR_TO_UTF8(*Token)), PlayerName, Exp, Error))
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Client token rejected: %s"), UTF8_TO_TCHAR(Error.c_str()));
+		return false;
+	}
+	Verified.PlayerName = UTF8_TO_TCHAR(PlayerName.c_str());
+	Verified.Exp = (int64)Exp;
+
+	OutPlayerName = Verified.PlayerName;
+	Verified.Token = Token;
+
+	FScopeLock Lock(&Impl->CacheLock);
+	Impl->Cache.Add(Hash, MoveTemp(Verified));
+	return true;
+}
+
+void DSSLiteTokens::FClientTokenVerifier::ResetCache()
+{
+	FScopeLock Lock(&Impl->CacheLock);
+	Impl->Cache.Empty(Impl->Cache.Max());
+}
@@ -0,0 +1,137 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "HubTrafficLog.h"
+#include "DSSLiteModule.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+FString FHubTrafficRecord::GetPayloadString() const
+{
+	FUTF8ToTCHAR Converted((const ANSICHAR*)Payload, PayloadSize);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+FHubTrafficRecorder::~FHubTrafficRecorder()
+{
+	Close();
+}
+
+bool FHubTrafficRecorder::Open(const FString& InFilename)
+{
+	Close();
+
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*InFilename));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Cannot open traffic log %s for writing."), *InFilename);
+		return false;
+	}
+
+	Buffer.Reset();
+	Buffer.Append(DSSTrafficLog::Magic, UE_ARRAY_COUNT(DSSTrafficLog::Magic));
+	Buffer.Add(DSSTrafficLog::Version);
+	LastCycles = 0;
+
+	UE_LOG(LogDSSLite, Display, TEXT("Recording hub traffic to %s."), *InFilename);
+	return true;
+}
+
+void FHubTrafficRecorder::Close()
+{
+	if (FileHandle.IsValid())
+	{
+		Flush();
+		FileHandle.Reset();
+	}
+}
+
+void FHubTrafficRecorder::Record(const FString& InFrame, bool bOutbound)
+{
+	if (!FileHandle.IsValid())
+		return;
+
+	const uint64 Cycles = FPlatformTime::Cycles64();
+	const uint64 DeltaMicros = LastCycles == 0 ? 0 : (uint64)(FPlatformTime::ToSeconds64(Cycles - LastCycles) * 1000000.0);
+	LastCycles = Cycles;
+
+	const int32 PayloadSize = FPlatformString::ConvertedLength<UTF8CHAR>(*InFrame, InFrame.Len());
+
+	Buffer.Add(bOutbound ? DSSTrafficLog::OutboundFlag : 0);
+	WriteVarInt(DeltaMicros);
+	WriteVarInt(PayloadSize);
+	const int32 PayloadOffset = Buffer.AddUninitialized(PayloadSize);
+	FPlatformString::Convert((UTF8CHAR*)Buffer.GetData() + PayloadOffset, PayloadSize, *InFrame, InFrame.Len());
+
+	if (Buffer.Num() >= 64 * 1024)
+	{
+		Flush();
+	}
+}
+
+void FHubTrafficRecorder::WriteVarInt(uint64 Value)
+{
+	do
+	{
+		uint8 Byte = Value & 0x7F;
+		Value >>= 7;
+		Buffer.Add(Value ? (Byte | 0x80) : Byte);
+	} while (Value);
+}
+
+void FHubTrafficRecorder::Flush()
+{
+	if (Buffer.Num() > 0)
+	{
+		FileHandle->Write(Buffer.GetData(), Buffer.Num());
+		FileHandle->Flush();
+		Buffer.Reset();
+	}
+}
+
+FHubTrafficLogReader::FHubTrafficLogReader(TArrayView<const uint8> InData) :
+	Data(InData)
+{
+	const int32 HeaderSize = UE_ARRAY_COUNT(DSSTrafficLog::Magic) + 1;
+	bValid = Data.Num() >= HeaderSize
+		&& FMemory::Memcmp(Data.GetData(), DSSTrafficLog::Magic, UE_ARRAY_COUNT(DSSTrafficLog::Magic)) == 0
+		&& Data[HeaderSize - 1] == DSSTrafficLog::Version;
+	Offset = HeaderSize;
+}
+
+bool FHubTrafficLogReader::Next(FHubTrafficRecord& OutRecord)
+{
+	if (!bValid || Offset >= Data.Num())
+		return false;
+
+	const uint8 Flags = Data[Offset++];
+	uint64 DeltaMicros = 0;
+	uint64 PayloadSize = 0;
+	// compare against what is left so a corrupt size can not wrap the offset
+	if (!ReadVarInt(DeltaMicros) || !ReadVarInt(PayloadSize) || PayloadSize > (uint64)(Data.Num() - Offset) || PayloadSize > (uint64)MAX_int32)
+	{
+		UE_LOG(LogDSSLite, Warning, TEXT("Truncated traffic log record at offset %lld."), Offset);
+		bValid = false;
+		return false;
+	}
+
+	Timestamp += DeltaMicros;
+	OutRecord.bOutbound = (Flags & DSSTrafficLog::OutboundFlag) != 0;
+	OutRecord.TimestampMicros = Timestamp;
+	OutRecord.Payload = (const UTF8CHAR*)(Data.GetData() + Offset);
+	OutRecord.PayloadSize = (int32)PayloadSize;
+	Offset += (int64)PayloadSize;
+	return true;
+}
+
+bool FHubTrafficLogReader::ReadVarInt(uint64& OutValue)
+{
+	OutValue = 0;
+	for (uint32 Shift = 0; Shift < 64 && Offset < Data.Num(); Shift += 7)
+	{
+		const uint8 Byte = Data[Offset++];
+		OutValue |= (uint64)(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/*
+* On-disk hub traffic log.
+* Header: 'D','S','S','R', uint8 version.
+* Record: uint8 flags (bit 0 = outbound), varint microseconds since previous record, varint payload size, UTF-8 payload.
+*/
+namespace DSSTrafficLog
+{
+	static constexpr uint8 Magic[4] = { 'D', 'S', 'S', 'R' };
+	static constexpr uint8 Version = 1;
+	static constexpr uint8 OutboundFlag = 1 << 0;
+}
+
+struct FHubTrafficRecord
+{
+	bool bOutbound = false;
+	uint64 TimestampMicros = 0;//since the first record
+	const UTF8CHAR* Payload = nullptr;
+	int32 PayloadSize = 0;
+
+	FString GetPayloadString() const;
+};
+
+/*appends frames to a traffic log, buffered and flushed every 64KB*/
+class FHubTrafficRecorder
+{
+public:
+	~FHubTrafficRecorder();
+
+	bool Open(const FString& InFilename);
+	void Close();
+	bool IsOpen() const
+	{
+		return FileHandle.IsValid();
+	}
+
+	void Record(const FString& InFrame, bool bOutbound);
+
+private:
+	void WriteVarInt(uint64 Value);
+	void Flush();
+
+	TUniquePtr<IFileHandle> FileHandle;
+	TArray<uint8> Buffer;
+	uint64 LastCycles = 0;
+};
+
+/*walks the records of a traffic log held in memory, payloads point into the given buffer*/
+class FHubTrafficLogReader
+{
+public:
+	explicit FHubTrafficLogReader(TArrayView<const uint8> InData);
+
+	bool IsValid() const
+	{
+		return bValid;
+	}
+
+	bool Next(FHubTrafficRecord& OutRecord);
+
+private:
+	bool ReadVarInt(uint64& OutValue);
+
+	TArrayView<const uint8> Data;
+	int64 Offset = 0;
+	uint64 Timestamp = 0;
+	bool bValid = false;
+};
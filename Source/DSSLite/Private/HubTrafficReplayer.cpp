@@ -0,0 +1,152 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "HubTrafficReplayer.h"
+#include "DSSLiteModule.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/MappedFileHandle.h"
+#include "../ThirdParty/SignalR/Private/HubConnection.h"
+
+static TSharedPtr<FHubTrafficReplayer> ConsoleReplayer;
+
+static FAutoConsoleCommand ReplayCommand(
+	TEXT("DSSLite.Replay"),
+	TEXT("DSSLite.Replay <File> [-fast] [-speed=1.0]: plays a recorded traffic log back through a detached hub connection."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() == 0)
+			{
+				UE_LOG(LogDSSLite, Display, TEXT("Usage: DSSLite.Replay <File> [-fast] [-speed=1.0]"));
+				return;
+			}
+
+			TSharedRef<FHubTrafficReplayer> Replayer = MakeShared<FHubTrafficReplayer>(MakeShared<FHubConnection>(TEXT("replay://") + Args[0], FString(), TMap<FString, FString>()));
+			if (!Replayer->Open(Args[0]))
+				return;
+
+			const FString Options = FString::Join(Args, TEXT(" "));
+			if (FParse::Param(*Options, TEXT("fast")))
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				const int32 Frames = Replayer->ReplayAll();
+				const double Elapsed = FPlatformTime::Seconds() - StartTime;
+				UE_LOG(LogDSSLite, Display, TEXT("Replayed %d frames in %.3f ms (%.0f frames/s)."), Frames, Elapsed * 1000.0, Elapsed > 0 ? Frames / Elapsed : 0.0);
+				return;
+			}
+
+			float Speed = 1.f;
+			FParse::Value(*Options, TEXT("speed="), Speed);
+			Replayer->Start(Speed);
+			ConsoleReplayer = Replayer;
+		}));
+
+FHubTrafficReplayer::FHubTrafficReplayer(TSharedRef<FHubConnection> InHub) :
+	Hub(InHub)
+{
+}
+
+FHubTrafficReplayer::~FHubTrafficReplayer()
+{
+	Reader.Reset();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FHubTrafficReplayer::Open(const FString& InFilename)
+{
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*InFilename));
+	if (!MappedFile.IsValid() || MappedFile->GetFileSize() == 0)
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Cannot map traffic log %s."), *InFilename);
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion.IsValid())
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("Cannot map traffic log %s."), *InFilename);
+		return false;
+	}
+
+	Reader = MakeUnique<FHubTrafficLogReader>(TArrayView<const uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()));
+	if (!Reader->IsValid())
+	{
+		UE_LOG(LogDSSLite, Error, TEXT("%s is not a DSSLite traffic log."), *InFilename);
+		return false;
+	}
+
+	bFinished = false;
+	bHasPendingRecord = false;
+	FramesReplayed = 0;
+	return true;
+}
+
+int32 FHubTrafficReplayer::ReplayAll()
+{
+	const int32 StartFrames = FramesReplayed;
+	while (ReadNextInbound())
+	{
+		Hub->ProcessMessage(PendingRecord.GetPayloadString());
+		bHasPendingRecord = false;
+		++FramesReplayed;
+	}
+	return FramesReplayed - StartFrames;
+}
+
+void FHubTrafficReplayer::Start(float InSpeed)
+{
+	Speed = FMath::Max(InSpeed, KINDA_SMALL_NUMBER);
+	PlaybackMicros = 0;
+	bPlaying = true;
+	ReplayPending();
+}
+
+TSharedRef<IHubConnection> FHubTrafficReplayer::GetHub() const
+{
+	return Hub;
+}
+
+void FHubTrafficReplayer::Tick(float DeltaTime)
+{
+	PlaybackMicros += DeltaTime * Speed * 1000000.0;
+	ReplayPending();
+}
+
+TStatId FHubTrafficReplayer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FHubTrafficReplayer, STATGROUP_Tickables);
+}
+
+bool FHubTrafficReplayer::ReadNextInbound()
+{
+	if (bHasPendingRecord)
+		return true;
+
+	while (Reader.IsValid() && Reader->Next(PendingRecord))
+	{
+		if (!PendingRecord.bOutbound)
+		{
+			bHasPendingRecord = true;
+			return true;
+		}
+	}
+
+	bFinished = true;
+	return false;
+}
+
+void FHubTrafficReplayer::ReplayPending()
+{
+	while (ReadNextInbound() && PendingRecord.TimestampMicros <= PlaybackMicros)
+	{
+		Hub->ProcessMessage(PendingRecord.GetPayloadString());
+		bHasPendingRecord = false;
+		++FramesReplayed;
+	}
+
+	if (bFinished)
+	{
+		bPlaying = false;
+		UE_LOG(LogDSSLite, Display, TEXT("Replay finished after %d frames."), FramesReplayed);
+	}
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "HubTrafficLog.h"
+
+class FHubConnection;
+class IHubConnection;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/*
+* Plays a recorded traffic log back into FHubConnection::ProcessMessage.
+* Only inbound frames are replayed, outbound frames are skipped.
+*/
+class FHubTrafficReplayer : public FTickableGameObject
+{
+public:
+	explicit FHubTrafficReplayer(TSharedRef<FHubConnection> InHub);
+	virtual ~FHubTrafficReplayer();
+
+	/*memory maps the log*/
+	bool Open(const FString& InFilename);
+
+	/*replays every remaining frame immediately, returns the number of frames replayed*/
+	int32 ReplayAll();
+
+	/*replays frames from Tick following the recorded timestamps, scaled by InSpeed*/
+	void Start(float InSpeed = 1.f);
+
+	bool IsFinished() const
+	{
+		return bFinished;
+	}
+
+	int32 GetFramesReplayed() const
+	{
+		return FramesReplayed;
+	}
+
+	TSharedRef<IHubConnection> GetHub() const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override
+	{
+		return bPlaying && !bFinished;
+	}
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+	virtual bool IsTickableWhenPaused() const override
+	{
+		return true;
+	}
+
+private:
+	bool ReadNextInbound();
+	void ReplayPending();
+
+	TSharedRef<FHubConnection> Hub;
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TUniquePtr<FHubTrafficLogReader> Reader;
+
+	FHubTrafficRecord PendingRecord;
+	bool bHasPendingRecord = false;
+
+	double PlaybackMicros = 0;
+	float Speed = 1.f;
+	bool bPlaying = false;
+	bool bFinished = true;
+	int32 FramesReplayed = 0;
+};
@@ -0,0 +1,94 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "InvocationLatency.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+static FAutoConsoleCommandWithOutputDevice DumpInvokeLatencyCommand(
+	TEXT("DSSLite.InvokeLatency.Dump"),
+	TEXT("Prints p50/p90/p99/max Invoke round trip latency per hub method."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+		{
+			FInvocationLatency::Get().Dump(Ar);
+		}));
+
+static FAutoConsoleCommand ResetInvokeLatencyCommand(
+	TEXT("DSSLite.InvokeLatency.Reset"),
+	TEXT("Clears the Invoke round trip latency histograms."),
+	FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FInvocationLatency::Get().Reset();
+		}));
+
+FInvocationLatency& FInvocationLatency::Get()
+{
+	static FInvocationLatency Instance;
+	return Instance;
+}
+
+void FInvocationLatency::Record(FName Target, double Seconds)
+{
+	const uint64 Micros = (uint64)FMath::Max(0.0, Seconds * 1000000.0);
+
+	FScopeLock Lock(&HistogramsLock);
+	TUniquePtr<FLatencyHistogram>& Histogram = Histograms.FindOrAdd(Target);
+	if (!Histogram.IsValid())
+	{
+		Histogram = MakeUnique<FLatencyHistogram>();
+	}
+	Histogram->Record(Micros);
+}
+
+bool FInvocationLatency::GetSummary(FName Target, FInvocationLatencySummary& OutSummary) const
+{
+	FScopeLock Lock(&HistogramsLock);
+	const TUniquePtr<FLatencyHistogram>* Histogram = Histograms.Find(Target);
+	if (Histogram == nullptr)
+		return false;
+
+	OutSummary = Summarize(**Histogram);
+	return true;
+}
+
+TMap<FName, FInvocationLatencySummary> FInvocationLatency::GetSummaries() const
+{
+	TMap<FName, FInvocationLatencySummary> Summaries;
+
+	FScopeLock Lock(&HistogramsLock);
+	for (const auto& Pair : Histograms)
+	{
+		Summaries.Add(Pair.Key, Summarize(*Pair.Value));
+	}
+	return Summaries;
+}
+
+void FInvocationLatency::Reset()
+{
+	FScopeLock Lock(&HistogramsLock);
+	for (auto& Pair : Histograms)
+	{
+		Pair.Value->Reset();
+	}
+}
+
+void FInvocationLatency::Dump(FOutputDevice& Ar) const
+{
+	const TMap<FName, FInvocationLatencySummary> Summaries = GetSummaries();
+	Ar.Logf(TEXT("%-32s %8s %10s %10s %10s %10s"), TEXT("Method"), TEXT("Count"), TEXT("p50 ms"), TEXT("p90 ms"), TEXT("p99 ms"), TEXT("max ms"));
+	for (const auto& Pair : Summaries)
+	{
+		const FInvocationLatencySummary& Summary = Pair.Value;
+		Ar.Logf(TEXT("%-32s %8llu %10.3f %10.3f %10.3f %10.3f"), *Pair.Key.ToString(), Summary.Count, Summary.P50Ms, Summary.P90Ms, Summary.P99Ms, Summary.MaxMs);
+	}
+}
+
+FInvocationLatencySummary FInvocationLatency::Summarize(const FLatencyHistogram& Histogram)
+{
+	FInvocationLatencySummary Summary;
+	Summary.Count = Histogram.GetCount();
+	Summary.P50Ms = Histogram.GetPercentile(50.0) / 1000.0;
+	Summary.P90Ms = Histogram.GetPercentile(90.0) / 1000.0;
+	Summary.P99Ms = Histogram.GetPercentile(99.0) / 1000.0;
+	Summary.MaxMs = Histogram.GetMax() / 1000.0;
+	return Summary;
+}
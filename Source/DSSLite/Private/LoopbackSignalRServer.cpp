@@ -0,0 +1,392 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "LoopbackSignalRServer.h"
+#include "LoopbackWebSocket.h"
+#include "DSSLiteModule.h"
+#include "Dom/JsonObject.h"
+#include "Misc/Guid.h"
+#include "../ThirdParty/SignalR/Private/JsonHubProtocol.h"
+#include "../ThirdParty/SignalR/Private/HandshakeProtocol.h"
+
+const TCHAR* FLoopbackSignalRServer::Scheme = TEXT("loopback://");
+
+static TMap<FString, TWeakPtr<FLoopbackSignalRServer>>& GetLoopbackServers()
+{
+	static TMap<FString, TWeakPtr<FLoopbackSignalRServer>> Servers;
+	return Servers;
+}
+
+TSharedRef<FLoopbackSignalRServer> FLoopbackSignalRServer::Create(const FString& InName)
+{
+	check(IsInGameThread());
+	TSharedRef<FLoopbackSignalRServer> Server = MakeShareable(new FLoopbackSignalRServer(InName));
+	GetLoopbackServers().Add(InName, Server);
+	return Server;
+}
+
+TSharedPtr<FLoopbackSignalRServer> FLoopbackSignalRServer::FindForUrl(const FString& InUrl, FString* OutPath)
+{
+	if (!InUrl.StartsWith(Scheme))
+		return nullptr;
+
+	FString Address = InUrl.RightChop(FCString::Strlen(Scheme));
+	int32 QueryPos;
+	if (Address.FindChar(TEXT('?'), QueryPos))
+	{
+		Address.LeftInline(QueryPos);
+	}
+
+	FString ServerName = Address;
+	FString Path;
+	int32 PathPos;
+	if (Address.FindChar(TEXT('/'), PathPos))
+	{
+		ServerName = Address.Left(PathPos);
+		Path = Address.RightChop(PathPos);
+	}
+
+	if (OutPath != nullptr)
+	{
+		*OutPath = Path;
+	}
+
+	const TWeakPtr<FLoopbackSignalRServer>* Server = GetLoopbackServers().Find(ServerName);
+	return Server != nullptr ? Server->Pin() : nullptr;
+}
+
+FLoopbackSignalRServer::FLoopbackSignalRServer(const FString& InName) :
+	Name(InName),
+	Protocol(MakeShared<FJsonHubProtocol>())
+{
+}
+
+FLoopbackSignalRServer::~FLoopbackSignalRServer()
+{
+	TMap<FString, TWeakPtr<FLoopbackSignalRServer>>& Servers = GetLoopbackServers();
+	const TWeakPtr<FLoopbackSignalRServer>* Registered = Servers.Find(Name);
+	if (Registered != nullptr && !Registered->IsValid())
+	{
+		Servers.Remove(Name);
+	}
+}
+
+FString FLoopbackSignalRServer::GetUrl(const FString& InHubPath) const
+{
+	return FString(Scheme) + Name + InHubPath;
+}
+
+void FLoopbackSignalRServer::SetLatency(float InLatencyMs, float InJitterMs)
+{
+	LatencyMs = FMath::Max(0.f, InLatencyMs);
+	JitterMs = FMath::Max(0.f, InJitterMs);
+}
+
+void FLoopbackSignalRServer::SetLossRate(float InLossRate)
+{
+	LossRate = FMath::Clamp(InLossRate, 0.f, 1.f);
+}
+
+void FLoopbackSignalRServer::SetKeepAliveInterval(float InSeconds)
+{
+	KeepAliveInterval = FMath::Max(0.f, InSeconds);
+	KeepAliveCounter = 0.f;
+}
+
+FLoopbackSignalRServer::FOnHubMethod& FLoopbackSignalRServer::On(FName InTarget)
+{
+	return Methods.FindOrAdd(InTarget);
+}
+
+void FLoopbackSignalRServer::Send(int32 InClientId, FName InTarget, const TArray<FSignalRValue>& InArguments)
+{
+	FInvocationMessage Invocation(FString(), InTarget.ToString(), InArguments);
+	SendFrame(InClientId, Protocol->SerializeMessage(&Invocation));
+}
+
+void FLoopbackSignalRServer::Broadcast(FName InTarget, const TArray<FSignalRValue>& InArguments)
+{
+	FInvocationMessage Invocation(FString(), InTarget.ToString(), InArguments);
+	const FString Frame = Protocol->SerializeMessage(&Invocation);
+	for (const auto& Pair : Clients)
+	{
+		if (Pair.Value.bHandshakeReceived)
+		{
+			SendFrame(Pair.Key, Frame);
+		}
+	}
+}
+
+void FLoopbackSignalRServer::Close(int32 InClientId, const FString& InError, bool bAllowReconnect)
+{
+	if (!Clients.Contains(InClientId))
+		return;
+
+	FCloseMessage CloseMessage;
+	if (!InError.IsEmpty())
+	{
+		CloseMessage.Error = InError;
+	}
+	CloseMessage.bAllowReconnect = bAllowReconnect;
+	const FString Frame = Protocol->SerializeMessage(&CloseMessage);
+
+	SendFrame(InClientId, Frame, true);
+	DisconnectClient(InClientId, 1000, InError);
+}
+
+void FLoopbackSignalRServer::CloseAll(const FString& InError, bool bAllowReconnect)
+{
+	for (int32 ClientId : GetClientIds())
+	{
+		Close(ClientId, InError, bAllowReconnect);
+	}
+}
+
+TArray<int32> FLoopbackSignalRServer::GetClientIds() const
+{
+	TArray<int32> ClientIds;
+	Clients.GetKeys(ClientIds);
+	return ClientIds;
+}
+
+FString FLoopbackSignalRServer::GetClientUrl(int32 InClientId) const
+{
+	const FClient* Client = Clients.Find(InClientId);
+	if (Client == nullptr)
+		return FString();
+
+	TSharedPtr<FLoopbackWebSocket> Socket = Client->Socket.Pin();
+	return Socket.IsValid() ? Socket->Url : FString();
+}
+
+void FLoopbackSignalRServer::Negotiate(const FString& InPath, TFunction<void(int32, const FString&)> InCallback)
+{
+	const FString ConnectionId = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+	const FString Content = FString::Printf(TEXT("{\"negotiateVersion\":1,\"connectionId\":\"%s\",\"connectionToken\":\"%s\",\"availableTransports\":[{\"transport\":\"WebSockets\",\"transferFormats\":[\"Text\"]}]}"), *ConnectionId, *ConnectionId);
+	UE_LOG(LogDSSLite, Verbose, TEXT("Loopback server %s negotiating %s"), *Name, *InPath);
+
+	Schedule([Callback = MoveTemp(InCallback), Content]()
+		{
+			Callback(200, Content);
+		});
+}
+
+TSharedRef<IWebSocket> FLoopbackSignalRServer::CreateWebSocket(const FString& InUrl)
+{
+	return MakeShared<FLoopbackWebSocket>(AsShared(), InUrl);
+}
+
+void FLoopbackSignalRServer::Tick(float DeltaTime)
+{
+	if (KeepAliveInterval > 0.f)
+	{
+		KeepAliveCounter += DeltaTime;
+		if (KeepAliveCounter >= KeepAliveInterval)
+		{
+			KeepAliveCounter = 0.f;
+			FPingMessage Ping;
+			const FString Frame = Protocol->SerializeMessage(&Ping);
+			for (const auto& Pair : Clients)
+			{
+				if (Pair.Value.bHandshakeReceived)
+				{
+					SendFrame(Pair.Key, Frame);
+				}
+			}
+		}
+	}
+
+	// actions may schedule new ones, those run on a later tick at the earliest
+	const double Now = FPlatformTime::Seconds();
+	const int32 NumDue = ScheduledActions.Num();
+	int32 Index = 0;
+	for (; Index < NumDue && ScheduledActions[Index].DueTime <= Now; ++Index)
+	{
+		TFunction<void()> Action = MoveTemp(ScheduledActions[Index].Action);
+		Action();
+	}
+	ScheduledActions.RemoveAt(0, Index, false);
+}
+
+TStatId FLoopbackSignalRServer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FLoopbackSignalRServer, STATGROUP_Tickables);
+}
+
+void FLoopbackSignalRServer::Schedule(TFunction<void()> InAction)
+{
+	// frames keep their order like on a real socket, jitter only delays the queue
+	double DueTime = FPlatformTime::Seconds() + (LatencyMs + FMath::FRandRange(0.f, JitterMs)) / 1000.0;
+	if (ScheduledActions.Num() > 0)
+	{
+		DueTime = FMath::Max(DueTime, ScheduledActions.Last().DueTime);
+	}
+	ScheduledActions.Add({ DueTime, MoveTemp(InAction) });
+}
+
+bool FLoopbackSignalRServer::ShouldDrop() const
+{
+	return LossRate > 0.f && FMath::FRand() < LossRate;
+}
+
+void FLoopbackSignalRServer::ConnectClient(const TSharedRef<FLoopbackWebSocket>& InSocket)
+{
+	Schedule([this, WeakSocket = TWeakPtr<FLoopbackWebSocket>(InSocket)]()
+		{
+			TSharedPtr<FLoopbackWebSocket> Socket = WeakSocket.Pin();
+			if (!Socket.IsValid())
+				return;
+
+			const int32 ClientId = NextClientId++;
+			FClient& Client = Clients.Add(ClientId);
+			Client.Socket = Socket;
+
+			Socket->ClientId = ClientId;
+			Socket->bConnecting = false;
+			Socket->bConnected = true;
+			Socket->OnConnected().Broadcast();
+			OnClientConnectedEvent.Broadcast(ClientId);
+		});
+}
+
+void FLoopbackSignalRServer::DisconnectClient(int32 InClientId, int32 InStatusCode, const FString& InReason)
+{
+	Schedule([this, InClientId, InStatusCode, InReason]()
+		{
+			FClient Client;
+			if (!Clients.RemoveAndCopyValue(InClientId, Client))
+				return;
+
+			if (TSharedPtr<FLoopbackWebSocket> Socket = Client.Socket.Pin())
+			{
+				Socket->bConnected = false;
+				Socket->OnClosed().Broadcast(InStatusCode, InReason, true);
+			}
+			OnClientDisconnectedEvent.Broadcast(InClientId);
+		});
+}
+
+void FLoopbackSignalRServer::ReceiveFrame(int32 InClientId, const FString& InFrame)
+{
+	const FClient* Client = Clients.Find(InClientId);
+	if (Client == nullptr || (Client->bHandshakeReceived && ShouldDrop()))
+		return;
+
+	Schedule([this, InClientId, InFrame]()
+		{
+			ProcessRecords(InClientId, InFrame);
+		});
+}
+
+void FLoopbackSignalRServer::SendFrame(int32 InClientId, const FString& InFrame, bool bReliable)
+{
+	if (!bReliable && ShouldDrop())
+		return;
+
+	Schedule([this, InClientId, InFrame]()
+		{
+			if (FClient* Client = Clients.Find(InClientId))
+			{
+				if (TSharedPtr<FLoopbackWebSocket> Socket = Client->Socket.Pin())
+				{
+					Socket->OnMessage().Broadcast(InFrame);
+				}
+			}
+		});
+}
+
+void FLoopbackSignalRServer::ProcessRecords(int32 InClientId, const FString& InRecords)
+{
+	FClient* Client = Clients.Find(InClientId);
+	if (Client == nullptr)
+		return;
+
+	FString Records = InRecords;
+	if (!Client->bHandshakeReceived)
+	{
+		auto Res = FHandshakeProtocol::ParseHandshakeResponse(Records);
+		const TSharedPtr<FJsonObject> HandshakeRequest = Res.Get<0>();
+		if (!HandshakeRequest.IsValid())
+		{
+			UE_LOG(LogDSSLite, Warning, TEXT("Loopback server %s received a bad handshake request."), *Name);
+			return;
+		}
+
+		FString ProtocolName;
+		if (!HandshakeRequest->TryGetStringField(TEXT("protocol"), ProtocolName) || ProtocolName != Protocol->Name().ToString())
+		{
+			SendFrame(InClientId, FString(TEXT("{\"error\":\"Unsupported protocol.\"}")) + FJsonHubProtocol::RecordSeparator, true);
+			return;
+		}
+
+		Client->bHandshakeReceived = true;
+		SendFrame(InClientId, FString(TEXT("{}")) + FJsonHubProtocol::RecordSeparator, true);
+		OnClientHandshakeEvent.Broadcast(InClientId);
+		Records = Res.Get<1>();
+	}
+
+	const TArray<TSharedPtr<FHubMessage>> Messages = Protocol->ParseMessages(Records, true);
+	for (const TSharedPtr<FHubMessage>& Message : Messages)
+	{
+		if (Message->MessageType != ESignalRMessageType::Invocation)
+			continue;
+
+		const FInvocationMessage* Invocation = StaticCast<const FInvocationMessage*>(Message.Get());
+		const FOnHubMethod* Method = Methods.Find(FName(*Invocation->Target));
+		const bool bHandled = Method != nullptr && Method->IsBound();
+		const FSignalRValue Result = bHandled ? Method->Execute(InClientId, Invocation->Arguments) : FSignalRValue();
+
+		if (!Invocation->InvocationId.IsEmpty())
+		{
+			const FString Error = bHandled ? FString() : FString::Printf(TEXT("Unknown hub method '%s'"), *Invocation->Target);
+			FCompletionMessage Completion(Invocation->InvocationId, Error, Result, bHandled);
+			SendFrame(InClientId, Protocol->SerializeMessage(&Completion));
+		}
+	}
+}
+
+FLoopbackWebSocket::FLoopbackWebSocket(const TSharedRef<FLoopbackSignalRServer>& InServer, const FString& InUrl) :
+	Server(InServer),
+	Url(InUrl)
+{
+}
+
+void FLoopbackWebSocket::Connect()
+{
+	if (bConnecting || bConnected)
+		return;
+
+	TSharedPtr<FLoopbackSignalRServer> SharedServer = Server.Pin();
+	if (!SharedServer.IsValid())
+	{
+		OnConnectionErrorEvent.Broadcast(TEXT("Loopback server is gone."));
+		return;
+	}
+
+	bConnecting = true;
+	SharedServer->ConnectClient(AsShared());
+}
+
+void FLoopbackWebSocket::Close(int32 Code, const FString& Reason)
+{
+	TSharedPtr<FLoopbackSignalRServer> SharedServer = Server.Pin();
+	if (bConnected && SharedServer.IsValid())
+	{
+		SharedServer->DisconnectClient(ClientId, Code, Reason);
+	}
+}
+
+void FLoopbackWebSocket::Send(const FString& Data)
+{
+	TSharedPtr<FLoopbackSignalRServer> SharedServer = Server.Pin();
+	if (bConnected && SharedServer.IsValid())
+	{
+		SharedServer->ReceiveFrame(ClientId, Data);
+		OnMessageSentEvent.Broadcast(Data);
+	}
+}
+
+void FLoopbackWebSocket::Send(const void* Data, SIZE_T Size, bool bIsBinary)
+{
+	FUTF8ToTCHAR Converted((const ANSICHAR*)Data, (int32)Size);
+	Send(FString(Converted.Length(), Converted.Get()));
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IWebSocket.h"
+#include "Misc/EngineVersionComparison.h"
+
+class FLoopbackSignalRServer;
+
+/*client end of a loopback connection, every event is delivered by FLoopbackSignalRServer::Tick*/
+class FLoopbackWebSocket : public IWebSocket, public TSharedFromThis<FLoopbackWebSocket>
+{
+public:
+	FLoopbackWebSocket(const TSharedRef<FLoopbackSignalRServer>& InServer, const FString& InUrl);
+
+	virtual void Connect() override;
+	virtual void Close(int32 Code = 1000, const FString& Reason = FString()) override;
+	virtual bool IsConnected() override
+	{
+		return bConnected;
+	}
+	virtual void Send(const FString& Data) override;
+	virtual void Send(const void* Data, SIZE_T Size, bool bIsBinary = false) override;
+#if !UE_VERSION_OLDER_THAN(5, 3, 0)
+	virtual void SetTextMessageMemoryLimit(uint64 TextMessageMemoryLimit) override
+	{
+	}
+#endif
+
+	virtual FWebSocketConnectedEvent& OnConnected() override
+	{
+		return OnConnectedEvent;
+	}
+	virtual FWebSocketConnectionErrorEvent& OnConnectionError() override
+	{
+		return OnConnectionErrorEvent;
+	}
+	virtual FWebSocketClosedEvent& OnClosed() override
+	{
+		return OnClosedEvent;
+	}
+	virtual FWebSocketMessageEvent& OnMessage() override
+	{
+		return OnMessageEvent;
+	}
+	virtual FWebSocketBinaryMessageEvent& OnBinaryMessage() override
+	{
+		return OnBinaryMessageEvent;
+	}
+	virtual FWebSocketRawMessageEvent& OnRawMessage() override
+	{
+		return OnRawMessageEvent;
+	}
+	virtual FWebSocketMessageSentEvent& OnMessageSent() override
+	{
+		return OnMessageSentEvent;
+	}
+
+private:
+	friend class FLoopbackSignalRServer;
+
+	TWeakPtr<FLoopbackSignalRServer> Server;
+	FString Url;
+	int32 ClientId = 0;
+	bool bConnecting = false;
+	bool bConnected = false;
+
+	FWebSocketConnectedEvent OnConnectedEvent;
+	FWebSocketConnectionErrorEvent OnConnectionErrorEvent;
+	FWebSocketClosedEvent OnClosedEvent;
+	FWebSocketMessageEvent OnMessageEvent;
+	FWebSocketBinaryMessageEvent OnBinaryMessageEvent;
+	FWebSocketRawMessageEvent OnRawMessageEvent;
+	FWebSocketMessageSentEvent OnMessageSentEvent;
+};
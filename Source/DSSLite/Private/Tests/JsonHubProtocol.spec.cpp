@@ -0,0 +1,235 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../ThirdParty/SignalR/Private/JsonHubProtocol.h"
+
+BEGIN_DEFINE_SPEC(FJsonHubProtocolSpec, "DSSLite.JsonHubProtocol", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	TSharedPtr<FJsonHubProtocol> Protocol;
+	FString Frame;//borrowed strings point into it, kept alive for the whole test
+	TArray<TSharedPtr<FHubMessage>> Parsed;
+
+	TArray<TSharedPtr<FHubMessage>> Parse(const FString& InRecord, bool bBorrowStrings = false)
+	{
+		Frame = InRecord + FJsonHubProtocol::RecordSeparator;
+		return Protocol->ParseMessages(Frame, bBorrowStrings);
+	}
+
+	/*
+	* Arguments of the single invocation record InArguments is wrapped in, empty if it was rejected.
+	* Returned by reference, copying the array would persist borrowed strings.
+	*/
+	const TArray<FSignalRValue>& ParseArguments(const FString& InArguments, bool bBorrowStrings = false)
+	{
+		static const TArray<FSignalRValue> Rejected;
+		Parsed = Parse(FString::Printf(TEXT("{\"type\":1,\"target\":\"Spec\",\"arguments\":%s}"), *InArguments), bBorrowStrings);
+		if (Parsed.Num() != 1 || Parsed[0]->MessageType != ESignalRMessageType::Invocation)
+			return Rejected;
+		return StaticCastSharedPtr<FInvocationMessage>(Parsed[0])->Arguments;
+	}
+
+	void ExpectRejectedRecords()
+	{
+		AddExpectedError(TEXT("SignalR message"), EAutomationExpectedErrorFlags::Contains, 0);
+	}
+END_DEFINE_SPEC(FJsonHubProtocolSpec)
+
+void FJsonHubProtocolSpec::Define()
+{
+	BeforeEach([this]()
+		{
+			Protocol = MakeShared<FJsonHubProtocol>();
+		});
+
+	AfterEach([this]()
+		{
+			Parsed.Reset();
+			Protocol.Reset();
+			Frame.Reset();
+		});
+
+	Describe("Numbers", [this]()
+		{
+			It("should keep integer literals as integers and anything with a fraction or an exponent as doubles", [this]()
+				{
+					const TArray<FSignalRValue>& Arguments = ParseArguments(TEXT("[1,1.0,-0,1e3,0.5,9007199254740993,-9223372036854775808,18446744073709551615]"));
+					if (!TestEqual(TEXT("Arguments"), Arguments.Num(), 8))
+						return;
+
+					TestTrue(TEXT("1 is an integer"), Arguments[0].IsInteger());
+					TestEqual(TEXT("1"), Arguments[0].AsInt(), (int64)1);
+					TestTrue(TEXT("1.0 is a double"), Arguments[1].IsDouble());
+					TestEqual(TEXT("1.0"), Arguments[1].AsDouble(), 1.0);
+					TestTrue(TEXT("-0 is an integer"), Arguments[2].IsInteger());
+					TestTrue(TEXT("1e3 is a double"), Arguments[3].IsDouble());
+					TestEqual(TEXT("1e3"), Arguments[3].AsDouble(), 1000.0);
+					TestTrue(TEXT("0.5 is a double"), Arguments[4].IsDouble());
+					TestEqual(TEXT("2^53 + 1 is exact"), Arguments[5].AsInt(), (int64)9007199254740993);
+					TestEqual(TEXT("MIN_int64"), Arguments[6].AsInt(), MIN_int64);
+					TestTrue(TEXT("MAX_uint64 is unsigned"), Arguments[7].IsUnsigned());
+					TestTrue(TEXT("MAX_uint64"), Arguments[7].AsUInt() == MAX_uint64);
+				});
+
+			It("should reject numbers outside the JSON grammar", [this]()
+				{
+					ExpectRejectedRecords();
+					for (const TCHAR* Number : { TEXT("+5"), TEXT("1e"), TEXT("01"), TEXT("-01"), TEXT("1."), TEXT(".5"), TEXT("-"), TEXT("1e+"), TEXT("1.2.3") })
+					{
+						TestEqual(FString::Printf(TEXT("Messages for %s"), Number), Parse(FString::Printf(TEXT("{\"type\":1,\"target\":\"Spec\",\"arguments\":[%s]}"), Number)).Num(), 0);
+					}
+				});
+
+			It("should reject records nested deeper than the limit", [this]()
+				{
+					ExpectRejectedRecords();
+					TestEqual(TEXT("Arguments at the limit"), ParseArguments(TEXT("[") + FString::ChrN(100, TEXT('[')) + FString::ChrN(100, TEXT(']')) + TEXT("]")).Num(), 1);
+					TestEqual(TEXT("Arguments past the limit"), ParseArguments(TEXT("[") + FString::ChrN(101, TEXT('[')) + FString::ChrN(101, TEXT(']')) + TEXT("]")).Num(), 0);
+					TestEqual(TEXT("Unterminated nesting"), ParseArguments(TEXT("[") + FString::ChrN(100000, TEXT('['))).Num(), 0);
+				});
+
+			It("should require an integer message type", [this]()
+				{
+					ExpectRejectedRecords();
+					TestEqual(TEXT("Messages"), Parse(TEXT("{\"type\":6.0}")).Num(), 0);
+					TestEqual(TEXT("Ping"), Parse(TEXT("{\"type\":6}")).Num(), 1);
+				});
+		});
+
+	Describe("Strings", [this]()
+		{
+			It("should decode escapes and surrogate pairs", [this]()
+				{
+					const TArray<FSignalRValue>& Arguments = ParseArguments(TEXT("[\"a\\\"b\\\\c\\/d\\n\\u00e9\",\"\\ud83d\\ude00\"]"));
+					if (!TestEqual(TEXT("Arguments"), Arguments.Num(), 2))
+						return;
+
+					TestEqual(TEXT("Escapes"), Arguments[0].AsString(), FString(TEXT("a\"b\\c/d\n\u00e9")));
+#if PLATFORM_TCHAR_IS_4_BYTES
+					const FString Emoji = FString::Chr((TCHAR)0x1F600);
+#else
+					FString Emoji;
+					Emoji.AppendChar((TCHAR)0xD83D);
+					Emoji.AppendChar((TCHAR)0xDE00);
+#endif
+					TestEqual(TEXT("Surrogate pair"), Arguments[1].AsString(), Emoji);
+				});
+
+			It("should reject lone surrogates", [this]()
+				{
+					ExpectRejectedRecords();
+					TestEqual(TEXT("High surrogate alone"), ParseArguments(TEXT("[\"\\ud83d\"]")).Num(), 0);
+					TestEqual(TEXT("Low surrogate alone"), ParseArguments(TEXT("[\"\\ude00\"]")).Num(), 0);
+					TestEqual(TEXT("High surrogate then a letter"), ParseArguments(TEXT("[\"\\ud83dx\"]")).Num(), 0);
+				});
+		});
+
+	Describe("Messages", [this]()
+		{
+			It("should accept null for invocationId and error", [this]()
+				{
+					TArray<TSharedPtr<FHubMessage>> Messages = Parse(TEXT("{\"type\":1,\"target\":\"Spec\",\"invocationId\":null,\"arguments\":[]}"));
+					if (TestEqual(TEXT("Invocation messages"), Messages.Num(), 1))
+					{
+						TestTrue(TEXT("No invocation id"), StaticCastSharedPtr<FInvocationMessage>(Messages[0])->InvocationId.IsEmpty());
+					}
+
+					Messages = Parse(TEXT("{\"type\":3,\"invocationId\":\"7\",\"error\":null,\"result\":5}"));
+					if (TestEqual(TEXT("Completion messages"), Messages.Num(), 1))
+					{
+						const TSharedPtr<FCompletionMessage> Completion = StaticCastSharedPtr<FCompletionMessage>(Messages[0]);
+						TestTrue(TEXT("No error"), Completion->Error.IsEmpty());
+						TestTrue(TEXT("Has result"), Completion->HasResult);
+						TestEqual(TEXT("Result"), Completion->Result.AsInt(), (int64)5);
+					}
+
+					Messages = Parse(TEXT("{\"type\":7,\"error\":null}"));
+					if (TestEqual(TEXT("Close messages"), Messages.Num(), 1))
+					{
+						TestFalse(TEXT("No close error"), StaticCastSharedPtr<FCloseMessage>(Messages[0])->Error.IsSet());
+					}
+				});
+
+			It("should decode stream messages so the connection can report them", [this]()
+				{
+					const TArray<TSharedPtr<FHubMessage>> Items = Parse(TEXT("{\"type\":2,\"invocationId\":\"1\",\"item\":5}"));
+					TestTrue(TEXT("Stream item"), Items.Num() == 1 && Items[0]->MessageType == ESignalRMessageType::StreamItem);
+					const TArray<TSharedPtr<FHubMessage>> Invocations = Parse(TEXT("{\"type\":4,\"invocationId\":\"2\",\"target\":\"Spec\",\"arguments\":[]}"));
+					TestTrue(TEXT("Stream invocation"), Invocations.Num() == 1 && Invocations[0]->MessageType == ESignalRMessageType::StreamInvocation);
+					const TArray<TSharedPtr<FHubMessage>> Cancels = Parse(TEXT("{\"type\":5,\"invocationId\":\"3\"}"));
+					TestTrue(TEXT("Cancel invocation"), Cancels.Num() == 1 && Cancels[0]->MessageType == ESignalRMessageType::CancelInvocation);
+				});
+
+			It("should decode every record of a frame", [this]()
+				{
+					Frame = FString(TEXT("{\"type\":6}")) + FJsonHubProtocol::RecordSeparator + TEXT("{\"type\":3,\"invocationId\":\"1\",\"result\":{\"k\":[1,2]}}") + FJsonHubProtocol::RecordSeparator;
+					const TArray<TSharedPtr<FHubMessage>> Messages = Protocol->ParseMessages(Frame);
+					if (!TestEqual(TEXT("Messages"), Messages.Num(), 2))
+						return;
+					TestTrue(TEXT("First is a ping"), Messages[0]->MessageType == ESignalRMessageType::Ping);
+					const TSharedPtr<FCompletionMessage> Completion = StaticCastSharedPtr<FCompletionMessage>(Messages[1]);
+					TestEqual(TEXT("Nested result"), Completion->Result.AsObject()[TEXT("k")].AsArray()[1].AsInt(), (int64)2);
+					TestEqual(TEXT("Nested result in the storage"), Completion->Result.AsSignalRObject()[TEXT("k")].AsArray()[1].AsInt(), (int64)2);
+					TestTrue(TEXT("The map is built once"), &Completion->Result.AsObject() == &Completion->Result.AsObject());
+				});
+		});
+
+	Describe("Borrowed strings", [this]()
+		{
+			// longer than the inline storage, shorter strings are never borrowed
+			static const TCHAR* Long = TEXT("b2c7a6f0-3c1e-4a7e-9d1a-5f0c2e8d9b41");
+
+			It("should borrow top level strings and own nested ones", [this]()
+				{
+					const TArray<FSignalRValue>& Arguments = ParseArguments(FString::Printf(TEXT("[\"%s\",[\"%s\"],{\"k\":\"%s\"},\"%s\\n\"]"), Long, Long, Long, Long), true);
+					if (!TestEqual(TEXT("Arguments"), Arguments.Num(), 4))
+						return;
+
+					TestTrue(TEXT("Top level string is borrowed"), Arguments[0].IsBorrowed());
+					TestEqual(TEXT("Borrowed value"), Arguments[0].AsString(), FString(Long));
+					TestFalse(TEXT("Array element is owned"), Arguments[1].AsArray()[0].IsBorrowed());
+					TestFalse(TEXT("Object field is owned"), Arguments[2].AsSignalRObject()[TEXT("k")].IsBorrowed());
+					TestFalse(TEXT("Escaped string is owned"), Arguments[3].IsBorrowed());
+				});
+
+			It("should not borrow without bBorrowStrings", [this]()
+				{
+					const TArray<FSignalRValue>& Arguments = ParseArguments(FString::Printf(TEXT("[\"%s\"]"), Long));
+					if (TestEqual(TEXT("Arguments"), Arguments.Num(), 1))
+					{
+						TestFalse(TEXT("Owned"), Arguments[0].IsBorrowed());
+					}
+				});
+
+			It("should make owned values on Persist and copy", [this]()
+				{
+					const TArray<TSharedPtr<FHubMessage>> Messages = Parse(FString::Printf(TEXT("{\"type\":1,\"target\":\"Spec\",\"arguments\":[\"%s\"]}"), Long), true);
+					if (!TestEqual(TEXT("Messages"), Messages.Num(), 1))
+						return;
+
+					// the arguments array is read in place, copying it would already persist the value
+					const FSignalRValue& Borrowed = StaticCastSharedPtr<FInvocationMessage>(Messages[0])->Arguments[0];
+					TestTrue(TEXT("Borrowed"), Borrowed.IsBorrowed());
+
+					const FSignalRValue Persisted = Borrowed.Persist();
+					const FSignalRValue Copied = Borrowed;
+					FSignalRValue Assigned;
+					Assigned = Borrowed;
+					TestFalse(TEXT("Persist owns"), Persisted.IsBorrowed());
+					TestFalse(TEXT("Copy owns"), Copied.IsBorrowed());
+					TestFalse(TEXT("Assignment owns"), Assigned.IsBorrowed());
+
+					// the owned values must not point into the frame any more
+					for (int32 Index = 0; Index < Frame.Len(); ++Index)
+					{
+						Frame[Index] = TEXT('x');
+					}
+					TestEqual(TEXT("Persisted value"), Persisted.AsString(), FString(Long));
+					TestEqual(TEXT("Copied value"), Copied.AsString(), FString(Long));
+					TestEqual(TEXT("Assigned value"), Assigned.AsString(), FString(Long));
+				});
+		});
+}
+
+#endif
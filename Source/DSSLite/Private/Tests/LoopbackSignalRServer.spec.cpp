@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DSSLiteModule.h"
+#include "IHubConnection.h"
+#include "LoopbackSignalRServer.h"
+#include "../DSSLiteCommandletUtils.h"
+
+using DSSLiteCommandlet::PumpUntil;
+
+BEGIN_DEFINE_SPEC(FLoopbackSignalRServerSpec, "DSSLite.LoopbackSignalRServer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+	TSharedPtr<FLoopbackSignalRServer> Server;
+	TSharedPtr<IHubConnection> Hub;
+	static constexpr double Timeout = 5.0;
+END_DEFINE_SPEC(FLoopbackSignalRServerSpec)
+
+void FLoopbackSignalRServerSpec::Define()
+{
+	BeforeEach([this]()
+		{
+			Server = FLoopbackSignalRServer::Create(TEXT("LoopbackSignalRServerSpec"));
+			Server->On(TEXT("Add")).BindLambda([](int32 ClientId, const TArray<FSignalRValue>& Arguments)
+				{
+					return FSignalRValue(Arguments[0].AsInt() + Arguments[1].AsInt());
+				});
+			Hub = FDSSLiteModule::Get().CreateHubConnection(Server->GetUrl(TEXT("/SpecHub")), TEXT("loopback"));
+		});
+
+	AfterEach([this]()
+		{
+			if (Hub->IsConnected())
+			{
+				Hub->Stop();
+				PumpUntil([this]() { return Server->GetNumClients() == 0; }, Timeout);
+			}
+			Hub.Reset();
+			Server.Reset();
+		});
+
+	It("should complete the handshake", [this]()
+		{
+			bool bConnected = false;
+			Hub->OnConnected().AddLambda([&bConnected]() { bConnected = true; });
+			Hub->Start();
+
+			TestTrue(TEXT("Connected before the timeout"), PumpUntil([&bConnected]() { return bConnected; }, Timeout));
+			TestTrue(TEXT("Hub reports connected"), Hub->IsConnected());
+			TestEqual(TEXT("Server clients"), Server->GetNumClients(), 1);
+		});
+
+	It("should return the handler result as the Invoke completion", [this]()
+		{
+			Hub->Start();
+			TestTrue(TEXT("Connected before the timeout"), PumpUntil([this]() { return Hub->IsConnected(); }, Timeout));
+
+			bool bCompleted = false;
+			int64 Result = 0;
+			Hub->Invoke(TEXT("Add"), 2, 40).BindLambda([&bCompleted, &Result](const FSignalRValue& Value)
+				{
+					bCompleted = true;
+					Result = Value.AsInt();
+				});
+
+			TestTrue(TEXT("Completed before the timeout"), PumpUntil([&bCompleted]() { return bCompleted; }, Timeout));
+			TestEqual(TEXT("Completion result"), Result, (int64)42);
+			TestEqual(TEXT("Pending invocations"), Hub->GetStats().PendingInvocations, 0);
+			TestTrue(TEXT("Invoke round trip recorded"), Hub->GetStats().InvokeRTTSeconds >= 0);
+		});
+
+	It("should deliver server invocations to the client handler", [this]()
+		{
+			FString Received;
+			Hub->On(TEXT("Notify")).BindLambda([&Received](const TArray<FSignalRValue>& Arguments)
+				{
+					Received = Arguments[0].AsString();
+				});
+			Hub->Start();
+			TestTrue(TEXT("Connected before the timeout"), PumpUntil([this]() { return Hub->IsConnected(); }, Timeout));
+
+			Server->Broadcast(TEXT("Notify"), { FSignalRValue(FString(TEXT("hello"))) });
+			TestTrue(TEXT("Received before the timeout"), PumpUntil([&Received]() { return !Received.IsEmpty(); }, Timeout));
+			TestEqual(TEXT("Argument"), Received, FString(TEXT("hello")));
+		});
+}
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+#include "CoreMinimal.h"
+#include "ConnectionStats.generated.h"
+
+/*snapshot of the hub connection counters, see IHubConnection::GetStats*/
+USTRUCT(BlueprintType)
+struct FDSSConnectionStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int64 BytesIn = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int64 BytesOut = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int64 FramesIn = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int64 FramesOut = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int64 RecordsIn = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int32 RecordsPerFrame = 0;//records carried by the last inbound frame
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	float ParseTimeMs = 0.f;//total time spent parsing inbound frames
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	float SerializeTimeMs = 0.f;//total time spent serializing outbound messages
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int32 QueueDepth = 0;//calls waiting for the handshake
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int32 PendingInvocations = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	int32 ReconnectCount = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	float InvokeRTTMs = -1.f;//last Invoke round trip, -1 until the first completion
+};
@@ -0,0 +1,166 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "SignalRValue.h"
+
+class FLoopbackSignalRServer;
+
+struct FDSSEmulatorLevel
+{
+	FString Name;
+	int32 Port = 0;
+	float SpinUpMs = 0.f;//delay before the first ClientTravel to this level, later travels find it running
+};
+
+struct FDSSEmulatorEvent
+{
+	float AtMs = 0.f;//since Start
+	FString Type;//ServerClose, PlayerDisconnected or AssignLevel
+	int32 Port = 0;//ServerClose/AssignLevel target, 0 targets every server
+	FString Name;//PlayerDisconnected player name, AssignLevel map
+};
+
+/*
+* Scenario file, JSON:
+* { "Name": "Emulator", "LatencyMs": 0, "JitterMs": 0, "Loss": 0, "ServerIP": "127.0.0.1", "SigningKey": "...",
+*   "Levels": [{ "Name": "Lobby", "Port": 7777, "SpinUpMs": 0 }], "DungeonBasePort": 9000, "DungeonSpinUpMs": 0,
+*   "Clients": 16, "TravelsPerClient": 10, "Travel": { "Options": 0, "Tag": "", "Location": [0, 0, 0], "Yaw": 0 },
+*   "Events": [{ "AtMs": 5000, "Type": "ServerClose", "Port": 7777 }] }
+*/
+struct DSSLITE_API FDSSEmulatorScenario
+{
+	FString Name = TEXT("DSSEmulator");
+
+	float LatencyMs = 0.f;
+	float JitterMs = 0.f;
+	float Loss = 0.f;
+
+	FString ServerIP = TEXT("127.0.0.1");
+	TArray<FDSSEmulatorLevel> Levels;
+	int32 DungeonBasePort = 9000;
+	float DungeonSpinUpMs = 0.f;
+
+	/*load, read by the emulator commandlet*/
+	FString SigningKey = TEXT("0000000000");
+	int32 Clients = 16;
+	int32 TravelsPerClient = 10;
+	int32 TravelOptions = 0;
+	FString TravelTag;
+	FVector TravelLocation = FVector::ZeroVector;
+	float TravelYaw = 0.f;
+
+	TArray<FDSSEmulatorEvent> Events;
+
+	static bool LoadFromFile(const FString& InFile, FDSSEmulatorScenario& OutScenario);
+	static bool LoadFromString(const FString& InJson, FDSSEmulatorScenario& OutScenario);
+};
+
+/*
+* Emulates the DSS ClientsHub/ServersHub contract on top of FLoopbackSignalRServer:
+* OnConnect after the handshake, Travel/TravelWithTag/TravelWithCoordinates answered with ClientTravel,
+* PlayerDisconnected pushed to servers when a client drops and ServerClose from the scenario events.
+* Servers that report ServerState only receive players once they are Warm.
+* Point the subsystem or a hub connection at GetUrl(), the hub path picks the role.
+*/
+class DSSLITE_API FDSSEmulator : public FTickableGameObject
+{
+public:
+	explicit FDSSEmulator(const FDSSEmulatorScenario& InScenario);
+	virtual ~FDSSEmulator();
+
+	/*base url without the hub path, e.g. loopback://DSSEmulator*/
+	FString GetUrl() const;
+	FString GetUrl(const FString& InHubPath) const;
+
+	const FDSSEmulatorScenario& GetScenario() const
+	{
+		return Scenario;
+	}
+	FLoopbackSignalRServer& GetServer() const
+	{
+		return *Server;
+	}
+
+	/*starts the scripted event timeline*/
+	void Start();
+	bool IsStarted() const
+	{
+		return StartTime >= 0.0;
+	}
+	bool HasPendingEvents() const
+	{
+		return NextEvent < Scenario.Events.Num();
+	}
+
+	int32 GetNumTravels() const
+	{
+		return NumTravels;
+	}
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual ETickableTickType GetTickableTickType() const override
+	{
+		return ETickableTickType::Always;
+	}
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+	virtual bool IsTickableWhenPaused() const override
+	{
+		return true;
+	}
+
+private:
+	enum class ERole : uint8
+	{
+		Client,
+		Server
+	};
+
+	struct FSession
+	{
+		ERole Role = ERole::Client;
+		FString PlayerName;//clients
+		int32 Port = 0;//servers
+		int32 State = INDEX_NONE;//servers, last ServerState, none until one is reported
+	};
+
+	struct FPendingPush
+	{
+		double DueTime;
+		int32 ClientId;
+		int32 Port;
+		TArray<FSignalRValue> Arguments;
+	};
+
+	void HandleHandshake(int32 InClientId);
+	void HandleDisconnected(int32 InClientId);
+	FSignalRValue HandleTravel(int32 InClientId, const TArray<FSignalRValue>& InArguments, int32 InOptions);
+	FSignalRValue HandleServerState(int32 InClientId, const TArray<FSignalRValue>& InArguments);
+	void FireEvent(const FDSSEmulatorEvent& InEvent);
+
+	/*port serving the map, OutSpinUpMs is set when the server is not running yet*/
+	int32 ResolvePort(const FString& InMapName, bool bIsDungeon, const FString& InInstanceId, float& OutSpinUpMs);
+	int32 FindClientByName(const FString& InPlayerName) const;
+	int32 FindServerByPort(int32 InPort) const;
+	bool IsServerReady(int32 InPort) const;
+
+	FDSSEmulatorScenario Scenario;
+	TSharedRef<FLoopbackSignalRServer> Server;
+
+	TMap<int32, FSession> Sessions;
+	TSet<int32> RunningPorts;
+	TMap<FString, int32> DungeonPorts;
+	int32 NextDungeonPort;
+
+	TArray<FPendingPush> PendingPushes;
+
+	double StartTime = -1.0;
+	int32 NextEvent = 0;
+	int32 NumTravels = 0;
+};
@@ -0,0 +1,8 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*kept apart from DSSLiteModule.h so the protocol, value and callback layers only need Core and Json*/
+DECLARE_LOG_CATEGORY_EXTERN(LogDSSLite, Log, All);
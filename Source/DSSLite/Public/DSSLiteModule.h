@@ -4,10 +4,9 @@
 
 #include "Modules/ModuleManager.h"
 #include "../ThirdParty/SignalR/Public/IHubConnection.h"
+#include "DSSLiteLog.h"
 
 
-DECLARE_LOG_CATEGORY_EXTERN(LogDSSLite, Log, All);
-
 class FDSSLiteModule : public IModuleInterface
 {
 public:
@@ -20,6 +19,13 @@ public:
 
 	DSSLITE_API TSharedPtr<IHubConnection> CreateHubConnection(const FString& InUrl, const FString& InToken, const TMap<FString, FString>& InHeaders = TMap<FString, FString>());
 
+	/*
+	* Dedicated servers launched by DSS start their ServersHub connection in StartupModule, so it overlaps with engine and map loading.
+	* Hands it over once, null if there is none, it was signed for another port or it already failed. OutOnConnectArguments receives an OnConnect that arrived before.
+	* The module's own OnConnect handler is removed, the caller binds its own.
+	*/
+	DSSLITE_API TSharedPtr<IHubConnection> AdoptServerHub(int32 InServerPort, TArray<FSignalRValue>& OutOnConnectArguments);
+
 private:
 	virtual bool SupportsDynamicReloading() override
 	{
@@ -35,4 +41,14 @@ private:
 
 	/** Whether this module has been initialized */
 	bool bInitialized = false;
+
+	/** Connections recorded so far with -DSSRecord */
+	int32 NumRecordedConnections = 0;
+
+	void StartServerHub();
+
+	/** ServersHub connection started by StartupModule, until the subsystem adopts it */
+	TSharedPtr<IHubConnection> ServerHub;
+	int32 ServerHubPort = 0;
+	TArray<FSignalRValue> ServerHubOnConnectArguments;
 };
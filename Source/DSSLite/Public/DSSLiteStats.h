@@ -0,0 +1,24 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("DSSLite"), STATGROUP_DSSLite, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Messages"), STAT_DSSLite_Parse, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Serialize Message"), STAT_DSSLite_Serialize, STATGROUP_DSSLite, DSSLITE_API);
+
+/*per frame traffic, cleared every frame*/
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes In"), STAT_DSSLite_BytesIn, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes Out"), STAT_DSSLite_BytesOut, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frames In"), STAT_DSSLite_FramesIn, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frames Out"), STAT_DSSLite_FramesOut, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Records In"), STAT_DSSLite_RecordsIn, STATGROUP_DSSLite, DSSLITE_API);
+
+/*connection state, kept across frames*/
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Records Per Frame"), STAT_DSSLite_RecordsPerFrame, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queue Depth"), STAT_DSSLite_QueueDepth, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Invocations"), STAT_DSSLite_PendingInvocations, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Reconnects"), STAT_DSSLite_Reconnects, STATGROUP_DSSLite, DSSLITE_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Invoke RTT (ms)"), STAT_DSSLite_InvokeRTT, STATGROUP_DSSLite, DSSLITE_API);
@@ -6,10 +6,16 @@
 #include "Misc/DateTime.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "TravelingOptions.h"
+#include "ConnectionStats.h"
+#include "ServerState.h"
+#include "UObject/SoftObjectPath.h"
 #include "Engine/GameInstance.h"
 #include "DSSLiteSubsystem.generated.h"
 
 class IHubConnection;
+class FSignalRValue;
+struct FStreamableHandle;
+namespace DSSLiteTokens { class FClientTokenVerifier; }
 
 UCLASS(DisplayName="DSSLiteSubsystem")
 class DSSLITE_API UDSSLiteSubsystem : public UGameInstanceSubsystem
@@ -32,6 +38,8 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FConnectionError, FString, Error);/*on connection error happened after connection attempt*/
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FShowLoadingScreen);/*triggered on travel*/
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPlayerDisconnected, FString, Name);/*On player disconnect from the game broadcast to UE Servers, Disabled on Lite Version*/
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FServerStateChanged, EDSSServerState, State);/*servers only, after the state was sent to DSS*/
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FLevelAssigned, FString, MapName);/*standby servers only, right before traveling to the assigned map*/
 	
 	UPROPERTY(BlueprintAssignable, meta = (DisplayName = "OnConnected", Keywords = ""), Category = "DSSLiteSubsystem")
 	FConnected OnConnected;
@@ -47,6 +55,10 @@ public:
 	FServerTerminate ServerTerminate;
 	UPROPERTY(BlueprintAssignable, meta = (DisplayName = "OnPlayerDisconnected", Keywords = ""), Category = "DSSLiteSubsystem")
 	FPlayerDisconnected OnPlayerDisconnected;
+	UPROPERTY(BlueprintAssignable, meta = (DisplayName = "OnServerStateChanged", Keywords = ""), Category = "DSSLiteSubsystem")
+	FServerStateChanged OnServerStateChanged;
+	UPROPERTY(BlueprintAssignable, meta = (DisplayName = "OnLevelAssigned", Keywords = ""), Category = "DSSLiteSubsystem")
+	FLevelAssigned OnLevelAssigned;
 
 	UFUNCTION()
 	void Disconnected();
@@ -98,12 +110,38 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Disconnect", Keywords = ""), Category = "DSSLiteSubsystem")
 		void Disconnect();
 
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetConnectionStats", Keywords = ""), Category = "DSSLiteSubsystem")
+		FDSSConnectionStats GetConnectionStats() const;
+
+	/*servers only, checks a player's client token against the AuthKey signing key. Verified tokens are cached until they expire*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "VerifyPlayerToken", Keywords = ""), Category = "DSSLiteSubsystem")
+		bool VerifyPlayerToken(const FString& Token, FString& PlayerName);
+
+	/*call from PreLogin with the login Options, reads DSSToken and rejects a PlayerName option that does not match the token*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "VerifyPlayerLogin", Keywords = ""), Category = "DSSLiteSubsystem")
+		bool VerifyPlayerLogin(const FString& Options, FString& PlayerName);
+
 	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
 	bool bIsManuallyLaunched;
+	UPROPERTY(BlueprintReadOnly, Category = "DSSLiteSubsystem")
+	bool bIsStandby;//pre-booted on a lightweight map until DSS sends AssignLevel
 	UPROPERTY(BlueprintReadWrite, Category = "DSSLiteSubsystem")
 	bool bAutoClientTravel;//Travel player to new server automatically, set false to override the logic
 	UPROPERTY(BlueprintReadWrite, Category = "DSSLiteSubsystem")
+	bool bPrefetchTravelMap;//clients start loading the target map while DSS finds a server, kept resident until the travel ends
+	UPROPERTY(BlueprintReadWrite, Category = "DSSLiteSubsystem")
 	bool bAutoServerClose;//terminate UE4 server automatically when it is empty, set false to override the logic
+	UPROPERTY(BlueprintReadWrite, Category = "DSSLiteSubsystem")
+	TArray<FSoftObjectPath> WarmUpAssets;//servers only, loaded after BeginPlay and kept resident before reporting Warm
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetServerState", Keywords = ""), Category = "DSSLiteSubsystem")
+	EDSSServerState GetServerState() const {
+		return ServerState;
+	}
+
+	/*servers only, the subsystem moves through Booting, MapLoaded and Warm by itself, set Draining to stop receiving players*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SetServerState", Keywords = ""), Category = "DSSLiteSubsystem")
+	void SetServerState(EDSSServerState State);
 
 	
 
@@ -114,6 +152,27 @@ private:
 	FString ConnectionID = "";
 	FString ClientID = "";
 	FDateTime CreatedOn = FDateTime::Now();
+	FString ClientToken = "";//sent as DSSToken when traveling without TravelSigningKey, an expired one cancels the travel
+	FString TravelSigningKey = "";//set by Connect, travel tokens are signed again so they do not expire on the way
+	TSharedPtr<DSSLiteTokens::FClientTokenVerifier> PlayerTokens;
+	bool bSigningToken = false;//Connect is waiting for its token
+	void ConnectWithServerToken(const FString& Connection, const FString& AuthenticationKey);
+	void BindHub();
+	EDSSServerState ServerState = EDSSServerState::Booting;
+	FDelegateHandle PostLoadMapHandle;
+	TSharedPtr<FStreamableHandle> WarmUpHandle;
+	void SendServerState();
+	void HandleMapLoaded(UWorld* World);
+	void HandleWorldBeginPlay();
+	void HandleWarmUpLoaded();
+	void HandleAssignLevel(const TArray<FSignalRValue>& Arguments);
+	TSharedPtr<FStreamableHandle> TravelMapHandle;
+	FTimerHandle TravelMapTimer;
+	bool FindMapPackage(const FString& MapName, FString& OutPackageName) const;
+	void PrefetchTravelMap(const FString& MapName);
+	void ReleaseTravelMap();
+	void ReceiveOnConnect(const TArray<FSignalRValue>& Arguments);
+	void ExecuteTravel(const FString& Address, int32 Port, const FString& PlayerName, const FString& TravelToken, const FString& UrlOptions);
 	void TravelAsync(FString MapName, bool bIsDungeon, FString InstanceID, TravelOptions TravelOptions, FString Tag, FVector Location, float Yaw, FString CharacterName="");
 	
 	
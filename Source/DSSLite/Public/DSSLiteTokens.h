@@ -0,0 +1,48 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+* HS256 tokens in the format DSS expects, see README "Connecting to DSS Server Node With Token"
+*/
+namespace DSSLiteTokens
+{
+	/*claims: port, role=server, key, exp*/
+	DSSLITE_API FString CreateServerToken(int32 Port, const FString& AuthKey, const FString& SigningKey, int32 ExpiresInSeconds = 60);
+
+	/*claims: name, role=client, exp*/
+	DSSLITE_API FString CreateClientToken(const FString& PlayerName, const FString& SigningKey, int32 ExpiresInSeconds = 60);
+
+	/*same tokens signed on a worker thread, OnSigned runs on the game thread. exp counts from the call*/
+	DSSLITE_API void CreateServerTokenAsync(int32 Port, const FString& AuthKey, const FString& SigningKey, int32 ExpiresInSeconds, TUniqueFunction<void(const FString&)> OnSigned);
+	DSSLITE_API void CreateClientTokenAsync(const FString& PlayerName, const FString& SigningKey, int32 ExpiresInSeconds, TUniqueFunction<void(const FString&)> OnSigned);
+
+	/*reads a string claim without verifying the signature*/
+	DSSLITE_API bool GetClaim(const FString& Token, const FString& Claim, FString& OutValue);
+
+	/*reads the exp claim without verifying the signature, false when the token has none*/
+	DSSLITE_API bool GetExpiry(const FString& Token, FDateTime& OutExpiry);
+
+	/*
+	* Checks client tokens (signature, role=client, exp) against one signing key.
+	* Tokens that pass are remembered until their exp, a repeated check is a hash lookup instead of a decode and HMAC.
+	* Thread safe.
+	*/
+	class DSSLITE_API FClientTokenVerifier
+	{
+	public:
+		explicit FClientTokenVerifier(const FString& SigningKey, int32 MaxCachedTokens = 4096);
+		~FClientTokenVerifier();
+
+		/*OutPlayerName receives the name claim*/
+		bool Verify(const FString& Token, FString& OutPlayerName);
+
+		void ResetCache();
+
+	private:
+		struct FImpl;
+		TUniquePtr<FImpl> Impl;
+	};
+}
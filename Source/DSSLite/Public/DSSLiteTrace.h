@@ -0,0 +1,12 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/*enable with -trace=cpu,DSSLite to see hub work and traffic in Insights*/
+UE_TRACE_CHANNEL_EXTERN(DSSLiteChannel, DSSLITE_API);
+
+#define DSSLITE_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, DSSLiteChannel)
+#define DSSLITE_TRACE_SCOPE_TEXT(Name) TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(Name, DSSLiteChannel)
@@ -0,0 +1,40 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LatencyHistogram.h"
+
+struct FInvocationLatencySummary
+{
+	uint64 Count = 0;
+	double P50Ms = 0;
+	double P90Ms = 0;
+	double P99Ms = 0;
+	double MaxMs = 0;
+};
+
+/*
+* Process wide Invoke round trip latencies, one histogram per hub method.
+* Dump with the DSSLite.InvokeLatency.Dump console command.
+*/
+class DSSLITE_API FInvocationLatency
+{
+public:
+	static FInvocationLatency& Get();
+
+	/*only allocates on the first completion of a hub method*/
+	void Record(FName Target, double Seconds);
+
+	bool GetSummary(FName Target, FInvocationLatencySummary& OutSummary) const;
+	TMap<FName, FInvocationLatencySummary> GetSummaries() const;
+
+	void Reset();
+	void Dump(FOutputDevice& Ar) const;
+
+private:
+	static FInvocationLatencySummary Summarize(const FLatencyHistogram& Histogram);
+
+	TMap<FName, TUniquePtr<FLatencyHistogram>> Histograms;
+	mutable FCriticalSection HistogramsLock;
+};
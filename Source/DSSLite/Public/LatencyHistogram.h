@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+* Fixed size log-linear latency histogram (HdrHistogram layout) with microsecond resolution.
+* Values below 32us are exact, above that every power of two is split in 16 buckets (~6% precision).
+* Recording never allocates.
+*/
+class FLatencyHistogram
+{
+public:
+	static constexpr uint32 SubBucketBits = 5;
+	static constexpr uint32 SubBucketCount = 1 << SubBucketBits;
+	static constexpr uint32 SubBucketHalfCount = SubBucketCount / 2;
+	static constexpr uint32 MaxValueBits = 36;//~19 hours in us, larger values are clamped
+	static constexpr uint32 NumBuckets = (MaxValueBits - SubBucketBits + 1) * SubBucketHalfCount + SubBucketHalfCount;
+
+	FLatencyHistogram()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		FMemory::Memzero(Counts, sizeof(Counts));
+		TotalCount = 0;
+		MaxValue = 0;
+	}
+
+	void Record(uint64 Micros)
+	{
+		++Counts[GetBucketIndex(Micros)];
+		++TotalCount;
+		MaxValue = FMath::Max(MaxValue, Micros);
+	}
+
+	uint64 GetCount() const
+	{
+		return TotalCount;
+	}
+
+	uint64 GetMax() const
+	{
+		return MaxValue;
+	}
+
+	/*highest value equivalent to the given percentile (0-100), in microseconds*/
+	uint64 GetPercentile(double Percentile) const
+	{
+		if (TotalCount == 0)
+			return 0;
+
+		const uint64 Target = FMath::Max<uint64>(1, (uint64)FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * TotalCount));
+		uint64 Cumulative = 0;
+		for (uint32 Index = 0; Index < NumBuckets; ++Index)
+		{
+			Cumulative += Counts[Index];
+			if (Cumulative >= Target)
+				return FMath::Min(GetBucketUpperValue(Index), MaxValue);
+		}
+		return MaxValue;
+	}
+
+private:
+	static uint32 GetBucketIndex(uint64 Value)
+	{
+		if (Value < SubBucketCount)
+			return (uint32)Value;
+
+		uint32 Exponent = FMath::FloorLog2_64(Value) - SubBucketBits + 1;
+		if (Exponent > MaxValueBits - SubBucketBits)
+			return NumBuckets - 1;
+
+		return Exponent * SubBucketHalfCount + (uint32)(Value >> Exponent);
+	}
+
+	static uint64 GetBucketUpperValue(uint32 Index)
+	{
+		if (Index < SubBucketCount)
+			return Index;
+
+		const uint32 Exponent = Index / SubBucketHalfCount - 1;
+		const uint64 SubBucket = Index - Exponent * SubBucketHalfCount;
+		return ((SubBucket + 1) << Exponent) - 1;
+	}
+
+	uint32 Counts[NumBuckets];
+	uint64 TotalCount;
+	uint64 MaxValue;
+};
@@ -0,0 +1,142 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "SignalRValue.h"
+
+class IWebSocket;
+class FLoopbackWebSocket;
+class FJsonHubProtocol;
+
+/*
+* In-process SignalR server stand-in for automation tests and benchmarks.
+* Hub connections created with a loopback://<Name>/<Hub> url negotiate and exchange frames with it without touching the network.
+* Implements negotiate, the JSON handshake, invocations, completions, pings and close, with scriptable latency and loss.
+*/
+class DSSLITE_API FLoopbackSignalRServer : public FTickableGameObject, public TSharedFromThis<FLoopbackSignalRServer>
+{
+public:
+	static const TCHAR* Scheme;
+
+	static TSharedRef<FLoopbackSignalRServer> Create(const FString& InName);
+
+	/*finds the server addressed by a loopback url, OutPath receives the hub path*/
+	static TSharedPtr<FLoopbackSignalRServer> FindForUrl(const FString& InUrl, FString* OutPath = nullptr);
+
+	virtual ~FLoopbackSignalRServer();
+
+	FString GetUrl(const FString& InHubPath) const;
+
+	/*one-way delay applied to every negotiate, frame and close, plus a random jitter in [0, InJitterMs]*/
+	void SetLatency(float InLatencyMs, float InJitterMs = 0.f);
+
+	/*probability in [0, 1] of dropping a frame after the handshake, in both directions. Close frames are never dropped*/
+	void SetLossRate(float InLossRate);
+
+	/*sends a ping to every client at this interval, 0 disables it*/
+	void SetKeepAliveInterval(float InSeconds);
+
+	/*handler result is returned as the completion of Invoke calls, unhandled targets complete with an error*/
+	DECLARE_DELEGATE_RetVal_TwoParams(FSignalRValue, FOnHubMethod, int32 /* ClientId */, const TArray<FSignalRValue>& /* Arguments */);
+	FOnHubMethod& On(FName InTarget);
+
+	/*server to client invocation*/
+	void Send(int32 InClientId, FName InTarget, const TArray<FSignalRValue>& InArguments = TArray<FSignalRValue>());
+	void Broadcast(FName InTarget, const TArray<FSignalRValue>& InArguments = TArray<FSignalRValue>());
+
+	/*sends a close message and drops the client*/
+	void Close(int32 InClientId, const FString& InError = FString(), bool bAllowReconnect = false);
+	void CloseAll(const FString& InError = FString(), bool bAllowReconnect = false);
+
+	TArray<int32> GetClientIds() const;
+
+	/*url the client socket was opened with, including the query string*/
+	FString GetClientUrl(int32 InClientId) const;
+	int32 GetNumClients() const
+	{
+		return Clients.Num();
+	}
+
+	DECLARE_EVENT_OneParam(FLoopbackSignalRServer, FOnClientEvent, int32 /* ClientId */);
+	FOnClientEvent& OnClientConnected()
+	{
+		return OnClientConnectedEvent;
+	}
+	FOnClientEvent& OnClientDisconnected()
+	{
+		return OnClientDisconnectedEvent;
+	}
+
+	/*fired once the handshake response is queued, frames sent from here reach the client after it*/
+	FOnClientEvent& OnClientHandshake()
+	{
+		return OnClientHandshakeEvent;
+	}
+
+	/*transport side, used by FConnection*/
+	void Negotiate(const FString& InPath, TFunction<void(int32 /* ResponseCode */, const FString& /* Content */)> InCallback);
+	TSharedRef<IWebSocket> CreateWebSocket(const FString& InUrl);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual ETickableTickType GetTickableTickType() const override
+	{
+		return ETickableTickType::Always;
+	}
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+	virtual bool IsTickableWhenPaused() const override
+	{
+		return true;
+	}
+
+private:
+	friend class FLoopbackWebSocket;
+
+	explicit FLoopbackSignalRServer(const FString& InName);
+
+	struct FClient
+	{
+		TWeakPtr<FLoopbackWebSocket> Socket;
+		bool bHandshakeReceived = false;
+	};
+
+	void Schedule(TFunction<void()> InAction);
+	bool ShouldDrop() const;
+
+	void ConnectClient(const TSharedRef<FLoopbackWebSocket>& InSocket);
+	void DisconnectClient(int32 InClientId, int32 InStatusCode, const FString& InReason);
+	void ReceiveFrame(int32 InClientId, const FString& InFrame);
+	void SendFrame(int32 InClientId, const FString& InFrame, bool bReliable = false);
+	void ProcessRecords(int32 InClientId, const FString& InRecords);
+
+	struct FScheduledAction
+	{
+		double DueTime;
+		TFunction<void()> Action;
+	};
+
+	FString Name;
+	TSharedRef<FJsonHubProtocol> Protocol;
+
+	TMap<int32, FClient> Clients;
+	int32 NextClientId = 1;
+
+	TMap<FName, FOnHubMethod> Methods;
+
+	TArray<FScheduledAction> ScheduledActions;
+
+	float LatencyMs = 0.f;
+	float JitterMs = 0.f;
+	float LossRate = 0.f;
+	float KeepAliveInterval = 0.f;
+	float KeepAliveCounter = 0.f;
+
+	FOnClientEvent OnClientConnectedEvent;
+	FOnClientEvent OnClientDisconnectedEvent;
+	FOnClientEvent OnClientHandshakeEvent;
+};
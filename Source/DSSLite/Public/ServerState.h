@@ -0,0 +1,16 @@
+// Copyright (c) 2022 Dynamic Servers Systems
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServerState.generated.h"
+
+/*dedicated server lifecycle reported to DSS with ServerState, players are routed to Warm servers only*/
+UENUM(BlueprintType)
+enum class EDSSServerState : uint8 {
+	Booting = 0 UMETA(DisplayName = "Booting"),
+	MapLoaded = 1 UMETA(DisplayName = "MapLoaded"),
+	Warm = 2 UMETA(DisplayName = "Warm"),//world has begun play and warm up assets are loaded
+	Draining = 3 UMETA(DisplayName = "Draining"),//closing, takes no new players
+	Standby = 4 UMETA(DisplayName = "Standby")//launched with -DSSStandby=true, waiting for AssignLevel
+};
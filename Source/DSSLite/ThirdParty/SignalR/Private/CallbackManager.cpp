@@ -24,6 +24,7 @@
 
 #include "CallbackManager.h"
 #include "Misc/ScopeLock.h"
+#include "InvocationLatency.h"
 
 FCallbackManager::FCallbackManager()
 {
@@ -34,29 +35,36 @@ FCallbackManager::~FCallbackManager()
     Clear(TEXT(""));
 }
 
-TTuple<FName, IHubConnection::FOnMethodCompletion&> FCallbackManager::RegisterCallback()
+TTuple<FName, IHubConnection::FOnMethodCompletion&> FCallbackManager::RegisterCallback(FName InTarget)
 {
     FName Id = GenerateCallbackId();
 
     FScopeLock Lock(&CallbacksLock);
-    IHubConnection::FOnMethodCompletion& qssq = Callbacks.Add(Id);
+    FPendingCallback& Pending = Callbacks.Add(Id);
+    Pending.Target = InTarget;
+    Pending.StartCycles = FPlatformTime::Cycles64();
 
-    return TTuple<FName, IHubConnection::FOnMethodCompletion&>(Id, qssq);
+    return TTuple<FName, IHubConnection::FOnMethodCompletion&>(Id, Pending.Delegate);
 }
 
-bool FCallbackManager::InvokeCallback(FName InCallbackId, const FSignalRValue& InArguments, bool InRemoveCallback)
+bool FCallbackManager::InvokeCallback(FName InCallbackId, const FSignalRValue& InArguments, bool InRemoveCallback, double* OutRoundTripSeconds)
 {
     IHubConnection::FOnMethodCompletion Callback;
+    FName Target;
+    uint64 StartCycles;
 
     {
         FScopeLock Lock(&CallbacksLock);
 
-        if(!Callbacks.Contains(InCallbackId))
+        FPendingCallback* Pending = Callbacks.Find(InCallbackId);
+        if(Pending == nullptr)
         {
             return false;
         }
 
-        Callback = Callbacks[InCallbackId];
+        Callback = Pending->Delegate;
+        Target = Pending->Target;
+        StartCycles = Pending->StartCycles;
 
         if (InRemoveCallback)
         {
@@ -64,6 +72,16 @@ bool FCallbackManager::InvokeCallback(FName InCallbackId, const FSignalRValue& I
         }
     }
 
+    const double RoundTripSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+    if (OutRoundTripSeconds != nullptr)
+    {
+        *OutRoundTripSeconds = RoundTripSeconds;
+    }
+    if (!Target.IsNone())
+    {
+        FInvocationLatency::Get().Record(Target, RoundTripSeconds);
+    }
+
     Callback.ExecuteIfBound(InArguments);
     return true;
 }
@@ -83,13 +101,19 @@ void FCallbackManager::Clear(const FString& ErrorMessage)
 
         for (auto& El : Callbacks)
         {
-            El.Value.ExecuteIfBound(FSignalRValue()); // TODO send error message
+            El.Value.Delegate.ExecuteIfBound(FSignalRValue()); // TODO send error message
         }
 
         Callbacks.Empty();
     }
 }
 
+int32 FCallbackManager::Num() const
+{
+    FScopeLock Lock(&CallbacksLock);
+    return Callbacks.Num();
+}
+
 FName FCallbackManager::GenerateCallbackId()
 {
     const auto CallbackId = CurrentId++;
@@ -33,16 +33,24 @@ public:
     FCallbackManager();
     ~FCallbackManager();
 
-    TTuple<FName, IHubConnection::FOnMethodCompletion&> RegisterCallback();
-    bool InvokeCallback(FName InCallbackId, const FSignalRValue& InArguments, bool InRemoveCallback);
+    TTuple<FName, IHubConnection::FOnMethodCompletion&> RegisterCallback(FName InTarget = NAME_None);
+    bool InvokeCallback(FName InCallbackId, const FSignalRValue& InArguments, bool InRemoveCallback, double* OutRoundTripSeconds = nullptr);
     bool RemoveCallback(FName InCallbackId);
     void Clear(const FString& ErrorMessage);
+    int32 Num() const;
 
 private:
     FName GenerateCallbackId();
 
-    TMap<FName, IHubConnection::FOnMethodCompletion> Callbacks;
-    FCriticalSection CallbacksLock;
+    struct FPendingCallback
+    {
+        IHubConnection::FOnMethodCompletion Delegate;
+        FName Target;
+        uint64 StartCycles = 0;
+    };
+
+    TMap<FName, FPendingCallback> Callbacks;
+    mutable FCriticalSection CallbacksLock;
 
     TAtomic<int> CurrentId;
 };
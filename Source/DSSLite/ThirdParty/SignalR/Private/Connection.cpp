@@ -32,6 +32,10 @@
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
+#include "DSSLiteStats.h"
+#include "DSSLiteTrace.h"
+#include "HubTrafficLog.h"
+#include "LoopbackSignalRServer.h"
 
 FConnection::FConnection(const FString& InHost, const FString& InToken, const TMap<FString, FString>& InHeaders):
     Host(InHost),
@@ -40,6 +44,10 @@ FConnection::FConnection(const FString& InHost, const FString& InToken, const TM
 {
 }
 
+FConnection::~FConnection()
+{
+}
+
 void FConnection::Connect()
 {
     Negotiate();
@@ -54,6 +62,17 @@ void FConnection::Send(const FString& Data)
 {
     if (Connection.IsValid())
     {
+        const int32 WireSize = GetWireSize(Data);
+        BytesSent += WireSize;
+        ++FramesSent;
+        INC_DWORD_STAT_BY(STAT_DSSLite_BytesOut, WireSize);
+        INC_DWORD_STAT(STAT_DSSLite_FramesOut);
+
+        if (Recorder.IsValid())
+        {
+            Recorder->Record(Data, true);
+        }
+
         Connection->Send(Data);
     }
     else
@@ -74,6 +93,22 @@ void FConnection::Close(int32 Code, const FString& Reason)
     }
 }
 
+bool FConnection::StartRecording(const FString& InFilename)
+{
+    TUniquePtr<FHubTrafficRecorder> NewRecorder = MakeUnique<FHubTrafficRecorder>();
+    if (!NewRecorder->Open(InFilename))
+    {
+        return false;
+    }
+    Recorder = MoveTemp(NewRecorder);
+    return true;
+}
+
+void FConnection::StopRecording()
+{
+    Recorder.Reset();
+}
+
 IWebSocket::FWebSocketConnectedEvent& FConnection::OnConnected()
 {
     return OnConnectedEvent;
@@ -96,6 +131,29 @@ IWebSocket::FWebSocketMessageEvent& FConnection::OnMessage()
 
 void FConnection::Negotiate()
 {
+    DSSLITE_TRACE_SCOPE("DSSLite::Negotiate");
+
+    if (Host.StartsWith(FLoopbackSignalRServer::Scheme))
+    {
+        FString HubPath;
+        TSharedPtr<FLoopbackSignalRServer> LoopbackServer = FLoopbackSignalRServer::FindForUrl(Host, &HubPath);
+        if (!LoopbackServer.IsValid())
+        {
+            UE_LOG(LogDSSLite, Error, TEXT("No loopback server found for %s"), *Host);
+            OnConnectionErrorEvent.Broadcast(TEXT("No loopback server found."));
+            return;
+        }
+
+        LoopbackServer->Negotiate(HubPath, [Self = TWeakPtr<FConnection>(AsShared())](int32 ResponseCode, const FString& Content)
+        {
+            if (TSharedPtr<FConnection> SharedSelf = Self.Pin())
+            {
+                SharedSelf->ProcessNegotiateResponse(ResponseCode, Content, FString());
+            }
+        });
+        return;
+    }
+
     TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FHttpModule::Get().CreateRequest();
 
 
@@ -107,14 +165,21 @@ void FConnection::Negotiate()
 
 void FConnection::OnNegotiateResponse(FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bConnectedSuccessfully)
 {
-    if(InResponse->GetResponseCode() != 200)
+    ProcessNegotiateResponse(InResponse->GetResponseCode(), InResponse->GetContentAsString(), InResponse->GetHeader("NewHost"));
+}
+
+void FConnection::ProcessNegotiateResponse(int32 ResponseCode, const FString& Content, const FString& InNewHost)
+{
+    DSSLITE_TRACE_SCOPE("DSSLite::NegotiateResponse");
+
+    if(ResponseCode != 200)
     {
-        UE_LOG(LogDSSLite, Error, TEXT("Negotiate failed with status code %d"), InResponse->GetResponseCode());
+        UE_LOG(LogDSSLite, Error, TEXT("Negotiate failed with status code %d"), ResponseCode);
         return;
     }
 
     TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject());
-    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(InResponse->GetContentAsString());
+    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(Content);
 
     if (FJsonSerializer::Deserialize(JsonReader, JsonObject) && JsonObject.IsValid())
     {
@@ -177,9 +242,9 @@ void FConnection::OnNegotiateResponse(FHttpRequestPtr InRequest, FHttpResponsePt
                 ConnectionId = JsonObject->GetStringField(TEXT("connectionToken"));
             }
             
-            if (!InResponse->GetHeader("NewHost").IsEmpty())
+            if (!InNewHost.IsEmpty())
             {
-                FString NewHost = InResponse->GetHeader("NewHost");
+                FString NewHost = InNewHost;
 
                 if (!NewHost.ToLower().StartsWith("http"))
                     NewHost = "http://" + NewHost;
@@ -192,14 +257,23 @@ void FConnection::OnNegotiateResponse(FHttpRequestPtr InRequest, FHttpResponsePt
     }
     else
     {
-        UE_LOG(LogDSSLite, Error, TEXT("Cannot parse negotiate response: %s"), *InResponse->GetContentAsString());
+        UE_LOG(LogDSSLite, Error, TEXT("Cannot parse negotiate response: %s"), *Content);
     }
 }
 
 void FConnection::StartWebSocket()
 {
+    DSSLITE_TRACE_SCOPE("DSSLite::StartWebSocket");
+
     const FString COnver = ConvertToWebsocketUrl(Host + FString::Printf(TEXT("?access_token=%s&client_version=%s"), *Token, *ClientVersion));
-    Connection = FWebSocketsModule::Get().CreateWebSocket(COnver, FString(), Headers);
+    if (TSharedPtr<FLoopbackSignalRServer> LoopbackServer = FLoopbackSignalRServer::FindForUrl(COnver))
+    {
+        Connection = LoopbackServer->CreateWebSocket(COnver);
+    }
+    else
+    {
+        Connection = FWebSocketsModule::Get().CreateWebSocket(COnver, FString(), Headers);
+    }
 
     if(Connection.IsValid())
     {
@@ -230,6 +304,17 @@ void FConnection::StartWebSocket()
         {
             if (TSharedPtr<FConnection> SharedSelf = Self.Pin())
             {
+                const int32 WireSize = GetWireSize(MessageString);
+                SharedSelf->BytesReceived += WireSize;
+                ++SharedSelf->FramesReceived;
+                INC_DWORD_STAT_BY(STAT_DSSLite_BytesIn, WireSize);
+                INC_DWORD_STAT(STAT_DSSLite_FramesIn);
+
+                if (SharedSelf->Recorder.IsValid())
+                {
+                    SharedSelf->Recorder->Record(MessageString, false);
+                }
+
                 SharedSelf->OnMessageEvent.Broadcast(MessageString);
             }
         });
@@ -259,3 +344,9 @@ FString FConnection::ConvertToWebsocketUrl(const FString& Url)
         return Url;
     }
 }
+
+int32 FConnection::GetWireSize(const FString& Data)
+{
+    // text frames go out as UTF-8
+    return FPlatformString::ConvertedLength<UTF8CHAR>(*Data, Data.Len());
+}
@@ -28,10 +28,13 @@
 #include "IWebSocket.h"
 #include "Interfaces/IHttpRequest.h"
 
+class FHubTrafficRecorder;
+
 class DSSLITE_API FConnection : public TSharedFromThis<FConnection>
 {
 public:
     FConnection(const FString& InHost, const FString& InToken, const TMap<FString, FString>& InHeaders);
+    ~FConnection();
 
     void Connect();
 
@@ -49,9 +52,18 @@ public:
 
     IWebSocket::FWebSocketMessageEvent& OnMessage();
 
+    FORCEINLINE uint64 GetBytesReceived() const { return BytesReceived; }
+    FORCEINLINE uint64 GetBytesSent() const { return BytesSent; }
+    FORCEINLINE uint64 GetFramesReceived() const { return FramesReceived; }
+    FORCEINLINE uint64 GetFramesSent() const { return FramesSent; }
+
+    bool StartRecording(const FString& InFilename);
+    void StopRecording();
+
 private:
     void Negotiate();
     void OnNegotiateResponse(FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bConnectedSuccessfully);
+    void ProcessNegotiateResponse(int32 ResponseCode, const FString& Content, const FString& InNewHost);
     void StartWebSocket();
 
     TSharedPtr<IWebSocket> Connection;
@@ -69,5 +81,14 @@ private:
     FString ConnectionToken;
     FString ConnectionId;
 
+    uint64 BytesReceived = 0;
+    uint64 BytesSent = 0;
+    uint64 FramesReceived = 0;
+    uint64 FramesSent = 0;
+
+    static int32 GetWireSize(const FString& Data);
+
+    TUniquePtr<FHubTrafficRecorder> Recorder;
+
     static FString ConvertToWebsocketUrl(const FString& Url);
 };
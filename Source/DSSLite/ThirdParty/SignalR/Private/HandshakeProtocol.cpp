@@ -26,7 +26,7 @@
 #include "IHubProtocol.h"
 #include "JsonHubProtocol.h"
 #include "Serialization/JsonSerializer.h"
-#include "DSSLiteModule.h"
+#include "DSSLiteLog.h"
 
 FString FHandshakeProtocol::CreateHandshakeMessage(TSharedPtr<IHubProtocol> InProtocol)
 {
@@ -29,12 +29,21 @@
 #include "MessageType.h"
 #include "Connection.h"
 #include "HandshakeProtocol.h"
+#include "DSSLiteStats.h"
+#include "DSSLiteTrace.h"
+
+// the protocol is stateless, one instance serves every connection
+static TSharedRef<IHubProtocol> GetSharedJsonHubProtocol()
+{
+    static TSharedRef<IHubProtocol> Protocol = MakeShared<FJsonHubProtocol>();
+    return Protocol;
+}
 
 FHubConnection::FHubConnection(const FString& InUrl, const FString& InToken, const TMap<FString, FString>& InHeaders):
     FTickableGameObject(),
     ConnectionState(EConnectionState::Disconnected),
     Host(InUrl),
-    HubProtocol(MakeShared<FJsonHubProtocol>())
+    HubProtocol(GetSharedJsonHubProtocol())
 {
     Connection = MakeShared<FConnection>(Host, InToken, InHeaders);
 
@@ -51,6 +60,8 @@ FHubConnection::~FHubConnection()
 	    SendCloseMessage();
         Connection->Close();
 	}
+    DEC_DWORD_STAT_BY(STAT_DSSLite_QueueDepth, WaitingCalls.Num());
+    DEC_DWORD_STAT_BY(STAT_DSSLite_PendingInvocations, CallbackManager.Num());
 }
 
 void FHubConnection::Start()
@@ -95,9 +106,15 @@ IHubConnection::FOnMethodInvocation& FHubConnection::On(FName InEventName)
     return InvocationHandlers.Add(InEventName);
 }
 
+void FHubConnection::Off(FName InEventName)
+{
+    InvocationHandlers.Remove(InEventName);
+}
+
 IHubConnection::FOnMethodCompletion& FHubConnection::Invoke(FName InEventName, const TArray<FSignalRValue>& InArguments)
 {
-    TTuple<FName, FOnMethodCompletion&> Callback = CallbackManager.RegisterCallback();
+    TTuple<FName, FOnMethodCompletion&> Callback = CallbackManager.RegisterCallback(InEventName);
+    INC_DWORD_STAT(STAT_DSSLite_PendingInvocations);
     InvokeHubMethod(InEventName, InArguments, Callback.Key);
     return Callback.Value;
 }
@@ -122,12 +139,44 @@ TStatId FHubConnection::GetStatId() const
     RETURN_QUICK_DECLARE_CYCLE_STAT(FHubConnection, STATGROUP_Tickables);
 }
 
+FHubConnectionStats FHubConnection::GetStats() const
+{
+    FHubConnectionStats Stats;
+    Stats.BytesIn = Connection->GetBytesReceived();
+    Stats.BytesOut = Connection->GetBytesSent();
+    Stats.FramesIn = Connection->GetFramesReceived();
+    Stats.FramesOut = Connection->GetFramesSent();
+    Stats.RecordsIn = RecordsIn;
+    Stats.RecordsPerFrame = RecordsPerFrame;
+    Stats.ParseTimeSeconds = ParseTimeSeconds;
+    Stats.SerializeTimeSeconds = SerializeTimeSeconds;
+    Stats.QueueDepth = WaitingCalls.Num();
+    Stats.PendingInvocations = CallbackManager.Num();
+    Stats.ReconnectCount = ReconnectCount;
+    Stats.InvokeRTTSeconds = InvokeRTTSeconds;
+    return Stats;
+}
+
+bool FHubConnection::StartRecording(const FString& InFilename)
+{
+    return Connection->StartRecording(InFilename);
+}
+
+void FHubConnection::StopRecording()
+{
+    Connection->StopRecording();
+}
+
 void FHubConnection::ProcessMessage(const FString& InMessageStr)
 {
+    DSSLITE_TRACE_SCOPE("DSSLite::ProcessMessage");
+
     FString MessageStr = InMessageStr;
 
 	if(!bHandshakeReceived)
 	{
+        DSSLITE_TRACE_SCOPE("DSSLite::HandshakeResponse");
+
         auto Res = FHandshakeProtocol::ParseHandshakeResponse(MessageStr);
 
         const TSharedPtr<FJsonObject> HandshakeResponseObject = Res.Get<0>();
@@ -156,6 +205,8 @@ void FHubConnection::ProcessMessage(const FString& InMessageStr)
                 {
                     Connection->Send(Call);
                 }
+                DEC_DWORD_STAT_BY(STAT_DSSLite_QueueDepth, WaitingCalls.Num());
+                WaitingCalls.Empty();
             }
 		}
         else
@@ -165,7 +216,19 @@ void FHubConnection::ProcessMessage(const FString& InMessageStr)
         }
 	}
 
-    auto Messages = HubProtocol->ParseMessages(MessageStr);
+    // string arguments borrow from MessageStr, handlers that keep one copy it or call Persist()
+    TArray<TSharedPtr<FHubMessage>> Messages;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_DSSLite_Parse);
+        const double ParseStartTime = FPlatformTime::Seconds();
+        Messages = HubProtocol->ParseMessages(MessageStr, true);
+        ParseTimeSeconds += FPlatformTime::Seconds() - ParseStartTime;
+    }
+
+    RecordsPerFrame = Messages.Num();
+    RecordsIn += RecordsPerFrame;
+    INC_DWORD_STAT_BY(STAT_DSSLite_RecordsIn, RecordsPerFrame);
+    SET_DWORD_STAT(STAT_DSSLite_RecordsPerFrame, RecordsPerFrame);
 
     for (auto const &Message : Messages)
     {
@@ -179,6 +242,7 @@ void FHubConnection::ProcessMessage(const FString& InMessageStr)
             FName MethodName = FName(*InvocationMessage->Target);
             if(InvocationHandlers.Contains(MethodName))
             {
+                DSSLITE_TRACE_SCOPE_TEXT(*InvocationMessage->Target);
                 InvocationHandlers[MethodName].ExecuteIfBound(InvocationMessage->Arguments);
             }
             break;
@@ -187,7 +251,7 @@ void FHubConnection::ProcessMessage(const FString& InMessageStr)
             UE_LOG(LogDSSLite, Warning, TEXT("Received unexpected message type 'StreamInvocation'"));
             break;
         case ESignalRMessageType::StreamItem:
-            // TODO
+            UE_LOG(LogDSSLite, Warning, TEXT("Received unexpected message type 'StreamItem'"));
             break;
         case ESignalRMessageType::Completion:
         {
@@ -200,8 +264,15 @@ void FHubConnection::ProcessMessage(const FString& InMessageStr)
             }
             else
             {
+                DSSLITE_TRACE_SCOPE("DSSLite::Completion");
                 FName InvocationId = FName(*CompletionMessage->InvocationId);
-                if (!CallbackManager.InvokeCallback(InvocationId, CompletionMessage->Result, true))
+                // SignalR pings are not acknowledged, completions are the only real round trip
+                if (CallbackManager.InvokeCallback(InvocationId, CompletionMessage->Result, true, &InvokeRTTSeconds))
+                {
+                    DEC_DWORD_STAT(STAT_DSSLite_PendingInvocations);
+                    SET_FLOAT_STAT(STAT_DSSLite_InvokeRTT, InvokeRTTSeconds * 1000.0);
+                }
+                else
                 {
                     UE_LOG(LogDSSLite, Warning, TEXT("No callback found for id: %s"), *InvocationId.ToString());
                 }
@@ -244,6 +315,8 @@ void FHubConnection::OnConnectionStarted()
 
     UE_LOG(LogDSSLite, Verbose, TEXT("Send handshake request"));
 
+    DSSLITE_TRACE_SCOPE("DSSLite::Handshake");
+
     bHandshakeReceived = false;
 
     Connection->Send(FHandshakeProtocol::CreateHandshakeMessage(HubProtocol));
@@ -251,13 +324,14 @@ void FHubConnection::OnConnectionStarted()
 
 void FHubConnection::OnConnectionError(const FString& InError)
 {
+    // the socket never opened, Start (and Reconnect) must be allowed again
+    ConnectionState = EConnectionState::Disconnected;
     OnHubConnectionErrorEvent.Broadcast(InError);
 
     if (bShouldReconnect)
     {
         bShouldReconnect = false;
-        UE_LOG(LogDSSLite, Verbose, TEXT("Reconnecting"));
-        Start();
+        Reconnect();
     }
 }
 
@@ -270,6 +344,7 @@ void FHubConnection::OnConnectionClosed(int32 StatusCode, const FString& Reason,
 
 	if(Connection.IsValid())
 	{
+        DEC_DWORD_STAT_BY(STAT_DSSLite_PendingInvocations, CallbackManager.Num());
         CallbackManager.Clear(TEXT("Connection was stopped before invocation result was received."));
 	}
     ConnectionState = EConnectionState::Disconnected;
@@ -281,8 +356,7 @@ void FHubConnection::OnConnectionClosed(int32 StatusCode, const FString& Reason,
         if (bShouldReconnect)
         {
             bShouldReconnect = false;
-            UE_LOG(LogDSSLite, Verbose, TEXT("Reconnecting"));
-            Start();
+            Reconnect();
         }
     }
 }
@@ -292,7 +366,7 @@ void FHubConnection::Ping()
     if (bHandshakeReceived)
     {
         FPingMessage Ping;
-        const auto Message = HubProtocol->SerializeMessage(&Ping);
+        const auto Message = SerializeMessage(&Ping);
         Connection->Send(Message);
         UE_LOG(LogDSSLite, VeryVerbose, TEXT("Ping sent"));
     }
@@ -308,7 +382,7 @@ void FHubConnection::InvokeHubMethod(FName MethodName, const TArray<FSignalRValu
 
     FInvocationMessage Invocation(CallbackIdStr, MethodName.ToString(), InArguments);
 
-    const auto Message = HubProtocol->SerializeMessage(&Invocation);
+    const auto Message = SerializeMessage(&Invocation);
 
     if (bHandshakeReceived)
     {
@@ -317,12 +391,30 @@ void FHubConnection::InvokeHubMethod(FName MethodName, const TArray<FSignalRValu
     else
     {
         WaitingCalls.Add(Message);
+        INC_DWORD_STAT(STAT_DSSLite_QueueDepth);
     }
 }
 
+FString FHubConnection::SerializeMessage(const FHubMessage* InMessage)
+{
+    SCOPE_CYCLE_COUNTER(STAT_DSSLite_Serialize);
+    const double SerializeStartTime = FPlatformTime::Seconds();
+    FString Message = HubProtocol->SerializeMessage(InMessage);
+    SerializeTimeSeconds += FPlatformTime::Seconds() - SerializeStartTime;
+    return Message;
+}
+
+void FHubConnection::Reconnect()
+{
+    UE_LOG(LogDSSLite, Verbose, TEXT("Reconnecting"));
+    ++ReconnectCount;
+    INC_DWORD_STAT(STAT_DSSLite_Reconnects);
+    Start();
+}
+
 void FHubConnection::SendCloseMessage()
 {
     FCloseMessage CloseMessage;
-    const auto Message = HubProtocol->SerializeMessage(&CloseMessage);
+    const auto Message = SerializeMessage(&CloseMessage);
     Connection->Send(Message);
 }
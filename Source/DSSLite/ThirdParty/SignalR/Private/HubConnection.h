@@ -58,6 +58,7 @@ public:
     }
 
     virtual FOnMethodInvocation& On(FName EventName) override;
+    virtual void Off(FName EventName) override;
     virtual FOnMethodCompletion& Invoke(FName EventName, const TArray<FSignalRValue>& InArguments = TArray<FSignalRValue>()) override;
     virtual void Send(FName InEventName, const TArray<FSignalRValue>& InArguments = TArray<FSignalRValue>()) override;
 
@@ -84,7 +85,19 @@ public:
     {
        return ConnectionState == EConnectionState::Connected;
     }
+
+    virtual bool IsConnecting() override
+    {
+       return ConnectionState == EConnectionState::Connecting;
+    }
+
+    virtual FHubConnectionStats GetStats() const override;
+
+    virtual bool StartRecording(const FString& InFilename) override;
+    virtual void StopRecording() override;
 protected:
+    friend class FHubTrafficReplayer;
+
     void ProcessMessage(const FString& InMessageStr);
 
 private:
@@ -103,6 +116,8 @@ private:
 
     void Ping();
     void InvokeHubMethod(FName MethodName, const TArray<FSignalRValue>& InArguments, FName CallbackId);
+    FString SerializeMessage(const FHubMessage* InMessage);
+    void Reconnect();
 
     FString Host;
 
@@ -125,4 +140,11 @@ private:
 
     bool bReceivedCloseMessage = false;
     bool bShouldReconnect = false;
+
+    uint64 RecordsIn = 0;
+    int32 RecordsPerFrame = 0;
+    double ParseTimeSeconds = 0;
+    double SerializeTimeSeconds = 0;
+    int32 ReconnectCount = 0;
+    double InvokeRTTSeconds = -1;
 };
\ No newline at end of file
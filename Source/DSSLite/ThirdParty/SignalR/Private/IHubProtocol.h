@@ -50,6 +50,11 @@ public:
      {
      }
 
+     FBaseInvocationMessage(FString&& InInvocationId, ESignalRMessageType InMessageType): FHubMessage(InMessageType),
+         InvocationId(MoveTemp(InInvocationId))
+     {
+     }
+
  public:
      const FString InvocationId;
 };
@@ -65,10 +70,10 @@ struct FInvocationMessage : FBaseInvocationMessage
     }
 
     FInvocationMessage(FString&& InInvocationId, FString&& InTarget, TArray<FSignalRValue>&& InArgs, TArray<FString>&& InStreamIds = TArray<FString>()) :
-        FBaseInvocationMessage(InInvocationId, ESignalRMessageType::Invocation),
-        Target(InTarget),
-        Arguments(InArgs),
-        StreamIds(InStreamIds)
+        FBaseInvocationMessage(MoveTemp(InInvocationId), ESignalRMessageType::Invocation),
+        Target(MoveTemp(InTarget)),
+        Arguments(MoveTemp(InArgs)),
+        StreamIds(MoveTemp(InStreamIds))
     {
     }
 
@@ -87,10 +92,10 @@ struct FCompletionMessage : FBaseInvocationMessage
     { }
 
     FCompletionMessage(FString&& InInvocationId, FString&& InError, FSignalRValue&& InResult, bool InHasResult) :
-        FBaseInvocationMessage(InInvocationId, ESignalRMessageType::Completion),
-        Error(InError),
+        FBaseInvocationMessage(MoveTemp(InInvocationId), ESignalRMessageType::Completion),
+        Error(MoveTemp(InError)),
         HasResult(InHasResult),
-        Result(InResult)
+        Result(MoveTemp(InResult))
     {
     }
 
@@ -99,6 +104,34 @@ struct FCompletionMessage : FBaseInvocationMessage
     FSignalRValue Result;
 };
 
+/* stream messages are not supported, they are decoded only so the connection can report them */
+struct FStreamItemMessage : FBaseInvocationMessage
+{
+    FStreamItemMessage(FString&& InInvocationId) :
+        FBaseInvocationMessage(MoveTemp(InInvocationId), ESignalRMessageType::StreamItem)
+    {
+    }
+};
+
+struct FStreamInvocationMessage : FBaseInvocationMessage
+{
+    FStreamInvocationMessage(FString&& InInvocationId, FString&& InTarget) :
+        FBaseInvocationMessage(MoveTemp(InInvocationId), ESignalRMessageType::StreamInvocation),
+        Target(MoveTemp(InTarget))
+    {
+    }
+
+    FString Target;
+};
+
+struct FCancelInvocationMessage : FBaseInvocationMessage
+{
+    FCancelInvocationMessage(FString&& InInvocationId) :
+        FBaseInvocationMessage(MoveTemp(InInvocationId), ESignalRMessageType::CancelInvocation)
+    {
+    }
+};
+
 struct FPingMessage : FHubMessage
 {
     FPingMessage() : FHubMessage(ESignalRMessageType::Ping)
@@ -125,5 +158,6 @@ public:
     virtual int Version() const = 0;
 
     virtual FString SerializeMessage(const FHubMessage*) const = 0;
-    virtual TArray<TSharedPtr<FHubMessage>> ParseMessages(const FString&) const = 0;
+    /* with bBorrowStrings, top level string arguments and results point into the frame: release the messages before the frame goes away */
+    virtual TArray<TSharedPtr<FHubMessage>> ParseMessages(const FString&, bool bBorrowStrings = false) const = 0;
 };
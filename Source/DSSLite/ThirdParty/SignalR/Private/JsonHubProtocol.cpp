@@ -26,7 +26,50 @@
 #include "Serialization/JsonSerializer.h"
 #include "Serialization/JsonWriter.h"
 #include "Misc/Base64.h"
-#include "DSSLiteModule.h"
+#include "Misc/Parse.h"
+#include "DSSLiteLog.h"
+#include "DSSLiteTrace.h"
+
+UE_TRACE_EVENT_BEGIN(DSSLite, Record)
+    UE_TRACE_EVENT_FIELD(uint64, Cycle)
+    UE_TRACE_EVENT_FIELD(uint32, Size)
+    UE_TRACE_EVENT_FIELD(uint8, MessageType)
+    UE_TRACE_EVENT_FIELD(bool, bOutbound)
+    UE_TRACE_EVENT_FIELD(UE::Trace::WideString, InvocationId)
+    UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Target)
+UE_TRACE_EVENT_END()
+
+static void TraceRecord(const FHubMessage* InMessage, int32 InSize, bool bOutbound)
+{
+#if UE_TRACE_ENABLED
+    if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(DSSLiteChannel) || InMessage == nullptr)
+    {
+        return;
+    }
+
+    const FString* InvocationId = nullptr;
+    const FString* Target = nullptr;
+    if (InMessage->MessageType == ESignalRMessageType::Invocation || InMessage->MessageType == ESignalRMessageType::Completion)
+    {
+        InvocationId = &StaticCast<const FBaseInvocationMessage*>(InMessage)->InvocationId;
+    }
+    if (InMessage->MessageType == ESignalRMessageType::Invocation)
+    {
+        Target = &StaticCast<const FInvocationMessage*>(InMessage)->Target;
+    }
+
+    UE_TRACE_LOG(DSSLite, Record, DSSLiteChannel)
+        << Record.Cycle(FPlatformTime::Cycles64())
+        << Record.Size(InSize)
+        << Record.MessageType(StaticCast<uint8>(InMessage->MessageType))
+        << Record.bOutbound(bOutbound)
+        << Record.InvocationId(InvocationId ? **InvocationId : TEXT(""), InvocationId ? InvocationId->Len() : 0)
+        << Record.Target(Target ? **Target : TEXT(""), Target ? Target->Len() : 0);
+#endif
+}
+
+/* largest magnitude a double holds without losing integer precision */
+static constexpr uint64 MaxExactInteger = 1ull << 53;
 
 FName FJsonHubProtocol::Name() const
 {
@@ -52,6 +95,15 @@ TSharedPtr<FJsonValue> SerializeValue(const FSignalRValue& InValue)
         }
     case FSignalRValue::EValueType::Number:
         {
+            // integers a double cannot hold exactly are written from their digits
+            if (InValue.IsUnsigned())
+            {
+                return MakeShared<FJsonValueNumberString>(LexToString(InValue.AsUInt()));
+            }
+            if (InValue.IsInteger() && (InValue.AsInt() > (int64)MaxExactInteger || InValue.AsInt() < -(int64)MaxExactInteger))
+            {
+                return MakeShared<FJsonValueNumberString>(LexToString(InValue.AsInt()));
+            }
             return MakeShared<FJsonValueNumber>(InValue.AsNumber());
         }
     case FSignalRValue::EValueType::String:
@@ -61,7 +113,7 @@ TSharedPtr<FJsonValue> SerializeValue(const FSignalRValue& InValue)
     case FSignalRValue::EValueType::Object:
         {
             TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
-            const auto& Object = InValue.AsObject();
+            const auto& Object = InValue.AsSignalRObject();
             for (const auto& Val : Object)
             {
                 JsonObject->SetField(Val.Key, SerializeValue(Val.Value));
@@ -94,6 +146,8 @@ TSharedPtr<FJsonValue> SerializeValue(const FSignalRValue& InValue)
 
 FString FJsonHubProtocol::SerializeMessage(const FHubMessage* InMessage) const
 {
+    DSSLITE_TRACE_SCOPE("DSSLite::Serialize");
+
     TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
 
     switch (InMessage->MessageType)
@@ -149,6 +203,10 @@ FString FJsonHubProtocol::SerializeMessage(const FHubMessage* InMessage) const
             {
                 JsonObject->SetStringField(TEXT("error"), CloseMessage->Error.GetValue());
             }
+            if (CloseMessage->bAllowReconnect.IsSet())
+            {
+                JsonObject->SetBoolField(TEXT("allowReconnect"), CloseMessage->bAllowReconnect.GetValue());
+            }
             break;
         }
     default:
@@ -159,6 +217,7 @@ FString FJsonHubProtocol::SerializeMessage(const FHubMessage* InMessage) const
     TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Out);
     if(FJsonSerializer::Serialize(JsonObject, JsonWriter))
     {
+        TraceRecord(InMessage, Out.Len() + 1, true);
         return Out + RecordSeparator;
     }
     else
@@ -168,187 +227,619 @@ FString FJsonHubProtocol::SerializeMessage(const FHubMessage* InMessage) const
     }
 }
 
-TArray<TSharedPtr<FHubMessage>> FJsonHubProtocol::ParseMessages(const FString& InStr) const
+/*
+ * Reads one record straight into FSignalRValue without building a FJsonValue tree. It is the only decoder, so numbers
+ * follow one rule: integer literals are integers, anything with a fraction or an exponent (1.0, 1e3) is a double.
+ * With bBorrowStrings, top level argument and result strings without escapes borrow from the record, nested
+ * strings are always owned so containers never have to be deep copied.
+ * Records it rejects are dropped, ReportInvalidMessage logs why.
+ */
+class FRecordReader
 {
-    TArray<TSharedPtr<FHubMessage>> Messages;
-
-    FString TmpStr(InStr);
+public:
+    FRecordReader(FStringView InRecord, bool bInBorrowStrings) :
+        Pos(InRecord.GetData()),
+        End(InRecord.GetData() + InRecord.Len()),
+        bBorrowStrings(bInBorrowStrings)
+    {
+    }
 
-    int32 Pos = 0;
-    while(TmpStr.FindChar(RecordSeparator, Pos))
+    TSharedPtr<FHubMessage> ReadMessage()
     {
-        FString MessagePayload = TmpStr.Mid(0, Pos);
-        TSharedPtr<FHubMessage> Message = ParseMessage(MessagePayload);
-        if (Message.IsValid())
+        int32 Type = -1;
+        FString Target;
+        FString InvocationId;
+        FString Error;
+        // arguments are collected on the stack and moved into one exact size array
+        TArray<FSignalRValue, TInlineAllocator<16>> ArgumentScratch;
+        FSignalRValue Result;
+        bool bHasArguments = false;
+        bool bHasResult = false;
+        bool bHasError = false;
+        TOptional<bool> bAllowReconnect;
+
+        if (!Expect(TEXT('{')))
+            return nullptr;
+
+        if (!Peek(TEXT('}')))
         {
-            Messages.Add(ParseMessage(MessagePayload));
-        }
+            do
+            {
+                FStringView Key;
+                if (!ReadRawString(Key) || !Expect(TEXT(':')))
+                    return nullptr;
 
-        TmpStr = TmpStr.Mid(Pos + 1);
-    }
+                if (Key == TEXT("type"))
+                {
+                    FSignalRValue Value;
+                    if (!ReadValue(Value) || !Value.IsInteger())
+                        return nullptr;
+                    Type = (int32)Value.AsInt();
+                }
+                else if (Key == TEXT("target"))
+                {
+                    if (!ReadOwnedString(Target))
+                        return nullptr;
+                }
+                else if (Key == TEXT("invocationId"))
+                {
+                    if (!ReadOptionalString(InvocationId))
+                        return nullptr;
+                }
+                else if (Key == TEXT("error"))
+                {
+                    if (!ReadOptionalString(Error, &bHasError))
+                        return nullptr;
+                }
+                else if (Key == TEXT("arguments"))
+                {
+                    if (!ReadArray(ArgumentScratch))
+                        return nullptr;
+                    bHasArguments = true;
+                }
+                else if (Key == TEXT("result"))
+                {
+                    if (!ReadValue(Result))
+                        return nullptr;
+                    bHasResult = true;
+                }
+                else if (Key == TEXT("allowReconnect"))
+                {
+                    FSignalRValue Value;
+                    if (!ReadValue(Value) || !Value.IsBoolean())
+                        return nullptr;
+                    bAllowReconnect = Value.AsBool();
+                }
+                else
+                {
+                    FSignalRValue Ignored;
+                    if (!ReadValue(Ignored))
+                        return nullptr;
+                }
+            } while (Accept(TEXT(',')));
+        }
 
-    return Messages;
-}
+        if (!Expect(TEXT('}')) || !AtEnd())
+            return nullptr;
 
-FSignalRValue DeserializeValue(TSharedPtr<FJsonValue> InValue)
-{
-    switch (InValue->Type)
-    {
-    case EJson::Boolean:
-        return FSignalRValue(InValue->AsBool());
-    case EJson::Number:
-        return FSignalRValue(InValue->AsNumber());
-    case EJson::String:
-        return FSignalRValue(InValue->AsString());
-    case EJson::Array:
-        {
-            TArray<FSignalRValue> OutValues;
-            for (const TSharedPtr<FJsonValue>& Val : InValue->AsArray())
+        switch (StaticCast<ESignalRMessageType>(Type))
+        {
+        case ESignalRMessageType::Invocation:
+            if (Target.IsEmpty() || !bHasArguments)
+                return nullptr;
             {
-                OutValues.Add(DeserializeValue(Val));
+                TArray<FSignalRValue> Arguments;
+                Arguments.Reserve(ArgumentScratch.Num());
+                for (FSignalRValue& Argument : ArgumentScratch)
+                {
+                    Arguments.Add(MoveTemp(Argument));
+                }
+                return MakeShared<FInvocationMessage>(MoveTemp(InvocationId), MoveTemp(Target), MoveTemp(Arguments));
             }
-            return FSignalRValue(MoveTemp(OutValues));
+        case ESignalRMessageType::Completion:
+            if (InvocationId.IsEmpty() || (!Error.IsEmpty() && bHasResult))
+                return nullptr;
+            return MakeShared<FCompletionMessage>(MoveTemp(InvocationId), MoveTemp(Error), MoveTemp(Result), bHasResult);
+        case ESignalRMessageType::StreamItem:
+            return MakeShared<FStreamItemMessage>(MoveTemp(InvocationId));
+        case ESignalRMessageType::StreamInvocation:
+            return MakeShared<FStreamInvocationMessage>(MoveTemp(InvocationId), MoveTemp(Target));
+        case ESignalRMessageType::CancelInvocation:
+            return MakeShared<FCancelInvocationMessage>(MoveTemp(InvocationId));
+        case ESignalRMessageType::Ping:
+            return MakeShared<FPingMessage>();
+        case ESignalRMessageType::Close:
+            {
+                TSharedPtr<FCloseMessage> CloseMessage = MakeShared<FCloseMessage>();
+                if (bHasError)
+                {
+                    CloseMessage->Error = MoveTemp(Error);
+                }
+                CloseMessage->bAllowReconnect = bAllowReconnect;
+                return CloseMessage;
+            }
+        default:
+            return nullptr;
         }
-    case EJson::Object:
+    }
+
+private:
+    /* same limit as flat_json, deeper records are rejected before they can exhaust the stack */
+    static constexpr int32 MaxDepth = 100;
+
+    bool ReadValue(FSignalRValue& OutValue)
+    {
+        SkipWhitespace();
+        if (Pos >= End)
+            return false;
+
+        switch (*Pos)
         {
-            TMap<FString, FSignalRValue> OutValues;
-            for (const auto& Pair : InValue->AsObject()->Values)
+        case TEXT('"'):
+            return ReadString(OutValue);
+        case TEXT('['):
+            {
+                TArray<FSignalRValue> Values;
+                if (Depth >= MaxDepth)
+                    return false;
+                ++Depth;
+                if (!ReadArray(Values))
+                    return false;
+                --Depth;
+                OutValue = FSignalRValue(MoveTemp(Values));
+                return true;
+            }
+        case TEXT('{'):
             {
-                OutValues.Add(Pair.Key, DeserializeValue(Pair.Value));
+                FSignalRObject Values;
+                if (Depth >= MaxDepth)
+                    return false;
+                ++Depth;
+                if (!ReadObject(Values))
+                    return false;
+                --Depth;
+                OutValue = FSignalRValue(MoveTemp(Values));
+                return true;
             }
-            return FSignalRValue(MoveTemp(OutValues));
+        case TEXT('t'):
+            OutValue = FSignalRValue(true);
+            return ReadLiteral(TEXT("true"));
+        case TEXT('f'):
+            OutValue = FSignalRValue(false);
+            return ReadLiteral(TEXT("false"));
+        case TEXT('n'):
+            OutValue = FSignalRValue(nullptr);
+            return ReadLiteral(TEXT("null"));
+        default:
+            return ReadNumber(OutValue);
         }
-    case EJson::Null:
-        return FSignalRValue(nullptr);
-    default:
-        return nullptr;
     }
-}
 
-TSharedPtr<FHubMessage> FJsonHubProtocol::ParseMessage(const FString& MessagePayload) const
-{
-    TSharedPtr<FJsonValue> JsonValue;
-    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(MessagePayload);
-    if (!FJsonSerializer::Deserialize(JsonReader, JsonValue))
+    template<typename AllocatorType>
+    bool ReadArray(TArray<FSignalRValue, AllocatorType>& OutValues)
     {
-        UE_LOG(LogDSSLite, Error, TEXT("Cannot unserialize SignalR message: %s: %s"), *JsonReader->GetErrorMessage(), *MessagePayload);
-        return nullptr;
+        if (!Expect(TEXT('[')))
+            return false;
+        if (Accept(TEXT(']')))
+            return true;
+
+        do
+        {
+            if (!ReadValue(OutValues.AddDefaulted_GetRef()))
+                return false;
+        } while (Accept(TEXT(',')));
+
+        return Expect(TEXT(']'));
     }
-    else if (JsonValue->Type != EJson::Object)
+
+    bool ReadObject(FSignalRObject& OutValues)
     {
-        UE_LOG(LogDSSLite, Error, TEXT("Message is not a 'object' type"));
-        return nullptr;
+        if (!Expect(TEXT('{')))
+            return false;
+        if (Accept(TEXT('}')))
+            return true;
+
+        do
+        {
+            FString Key;
+            FSignalRValue Value;
+            if (!ReadOwnedString(Key) || !Expect(TEXT(':')) || !ReadValue(Value))
+                return false;
+            OutValues.Add(MoveTemp(Key), MoveTemp(Value));
+        } while (Accept(TEXT(',')));
+
+        return Expect(TEXT('}'));
     }
-    else
+
+    bool ReadString(FSignalRValue& OutValue)
     {
-        TSharedPtr<FJsonObject> Obj = JsonValue->AsObject();
-        if (!Obj->HasTypedField<EJson::Number>(TEXT("type")))
+        const TCHAR* Start = Pos + 1;
+        FStringView Raw;
+        if (ReadRawString(Raw))
         {
-            UE_LOG(LogDSSLite, Error, TEXT("Field 'type' not found in message %s"), *MessagePayload);
-            return nullptr;
+            OutValue = bBorrowStrings && Depth == 0 ? FSignalRValue::Borrow(Raw) : FSignalRValue(FString(Raw));
+            return true;
         }
-        else
-        {
-            TSharedPtr<FHubMessage> Message;
 
-            switch (StaticCast<ESignalRMessageType>((int)Obj->GetNumberField(TEXT("type"))))
-            {
-            case ESignalRMessageType::Invocation:
-            {
-                if (!Obj->HasTypedField<EJson::String>(TEXT("target")))
-                {
-                    UE_LOG(LogDSSLite, Error, TEXT("Field 'target' not found in invocation message %s"), *MessagePayload);
-                    return nullptr;
-                }
-                else if (!Obj->HasTypedField<EJson::Array>(TEXT("arguments")))
-                {
-                    UE_LOG(LogDSSLite, Error, TEXT("Field 'arguments' not found in invocation message %s"), *MessagePayload);
-                    return nullptr;
-                }
+        Pos = Start - 1;
+        FString Unescaped;
+        if (!ReadEscapedString(Unescaped))
+            return false;
+        OutValue = FSignalRValue(MoveTemp(Unescaped));
+        return true;
+    }
 
-                FString Target = Obj->GetStringField(TEXT("target"));
+    /* string without escapes, as a view into the record */
+    bool ReadRawString(FStringView& OutView)
+    {
+        if (!Expect(TEXT('"')))
+            return false;
 
-                TArray<TSharedPtr<FJsonValue>> JsonArguments = Obj->GetArrayField(TEXT("arguments"));
-                TArray<FSignalRValue> Arguments;
-                for (const auto& JsonArgument : JsonArguments)
-                {
-                    Arguments.Add(DeserializeValue(JsonArgument));
-                }
+        const TCHAR* Start = Pos;
+        while (Pos < End && *Pos != TEXT('"'))
+        {
+            if (*Pos == TEXT('\\'))
+                return false;
+            ++Pos;
+        }
+        if (Pos >= End)
+            return false;
 
-                FString InvocationId;
-                if (Obj->HasTypedField<EJson::String>(TEXT("invocationId")))
-                {
-                    InvocationId = Obj->GetStringField(TEXT("invocationId"));
-                }
+        OutView = FStringView(Start, (int32)(Pos - Start));
+        ++Pos;
+        return true;
+    }
 
-                Message = MakeShared<FInvocationMessage>(InvocationId, Target, Arguments);
+    /* string field that may also be null, OutbPresent is only set for a string */
+    bool ReadOptionalString(FString& OutString, bool* OutbPresent = nullptr)
+    {
+        if (Peek(TEXT('n')))
+            return ReadLiteral(TEXT("null"));
+        if (!ReadOwnedString(OutString))
+            return false;
+        if (OutbPresent != nullptr)
+        {
+            *OutbPresent = true;
+        }
+        return true;
+    }
 
-                // TODO: Stream Ids
+    /* strings without escapes are copied in one exact size allocation */
+    bool ReadOwnedString(FString& OutString)
+    {
+        const TCHAR* Start = Pos;
+        FStringView Raw;
+        if (ReadRawString(Raw))
+        {
+            OutString = FString(Raw);
+            return true;
+        }
+        Pos = Start;
+        return ReadEscapedString(OutString);
+    }
 
-                break;
-            }
-            case ESignalRMessageType::Completion:
+    bool ReadEscapedString(FString& OutString)
+    {
+        if (!Expect(TEXT('"')))
+            return false;
+
+        while (Pos < End && *Pos != TEXT('"'))
+        {
+            TCHAR Char = *Pos++;
+            if (Char == TEXT('\\'))
             {
-                if (!Obj->HasTypedField<EJson::String>(TEXT("invocationId")))
+                if (Pos >= End)
+                    return false;
+                switch (*Pos++)
                 {
-                    UE_LOG(LogDSSLite, Error, TEXT("Field 'invocationId' not found in completion message %s"), *MessagePayload);
-                    return nullptr;
+                case TEXT('"'): Char = TEXT('"'); break;
+                case TEXT('\\'): Char = TEXT('\\'); break;
+                case TEXT('/'): Char = TEXT('/'); break;
+                case TEXT('b'): Char = TEXT('\b'); break;
+                case TEXT('f'): Char = TEXT('\f'); break;
+                case TEXT('n'): Char = TEXT('\n'); break;
+                case TEXT('r'): Char = TEXT('\r'); break;
+                case TEXT('t'): Char = TEXT('\t'); break;
+                case TEXT('u'):
+                    {
+                        uint32 Code;
+                        if (!ReadHex4(Code) || (Code >= 0xDC00 && Code <= 0xDFFF))
+                            return false;
+                        if (Code >= 0xD800 && Code <= 0xDBFF)
+                        {
+                            // a high surrogate must be followed by an escaped low surrogate
+                            uint32 Low;
+                            if (End - Pos < 2 || Pos[0] != TEXT('\\') || Pos[1] != TEXT('u'))
+                                return false;
+                            Pos += 2;
+                            if (!ReadHex4(Low) || Low < 0xDC00 || Low > 0xDFFF)
+                                return false;
+#if PLATFORM_TCHAR_IS_4_BYTES
+                            Code = 0x10000 + ((Code - 0xD800) << 10) + (Low - 0xDC00);
+#else
+                            OutString.AppendChar((TCHAR)Code);
+                            Code = Low;
+#endif
+                        }
+                        Char = (TCHAR)Code;
+                        break;
+                    }
+                default:
+                    return false;
                 }
+            }
+            OutString.AppendChar(Char);
+        }
+        if (Pos >= End)
+            return false;
 
-                FString InvocationId = Obj->GetStringField(TEXT("invocationId"));
-
-                FString Error;
-                if (Obj->HasTypedField<EJson::String>(TEXT("error")))
-                {
-                    Error = Obj->GetStringField(TEXT("error"));
-                }
+        ++Pos;
+        return true;
+    }
 
-                bool bHasResult = false;
-                FSignalRValue Result;
-                if (Obj->HasField(TEXT("result")))
-                {
-                    bHasResult = true;
-                    Result = DeserializeValue(Obj->TryGetField(TEXT("result")));
-                }
+    bool ReadHex4(uint32& OutCode)
+    {
+        if (End - Pos < 4)
+            return false;
+        OutCode = 0;
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            const TCHAR Hex = *Pos++;
+            if (!FChar::IsHexDigit(Hex))
+                return false;
+            OutCode = (OutCode << 4) | FParse::HexDigit(Hex);
+        }
+        return true;
+    }
 
-                if (!Error.IsEmpty() && bHasResult)
-                {
-                    UE_LOG(LogDSSLite, Error, TEXT("Fields 'error' and 'result' properties are mutually exclusive in completion message %s"), *MessagePayload);
-                    return nullptr;
-                }
+    /* JSON number grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, anything else (+5, 1.2.3, 1e) fails the record */
+    bool ReadNumber(FSignalRValue& OutValue)
+    {
+        if (ReadInteger(OutValue))
+            return true;
 
-                Message = MakeShared<FCompletionMessage>(InvocationId, Error, Result, bHasResult);
-                break;
-            }
-            case ESignalRMessageType::Ping:
+        const TCHAR* Start = Pos;
+        const TCHAR* Cursor = Pos;
+        if (Cursor < End && *Cursor == TEXT('-'))
+        {
+            ++Cursor;
+        }
+        if (!ReadDigits(Cursor, true))
+            return false;
+        if (Cursor < End && *Cursor == TEXT('.'))
+        {
+            ++Cursor;
+            if (!ReadDigits(Cursor, false))
+                return false;
+        }
+        if (Cursor < End && (*Cursor == TEXT('e') || *Cursor == TEXT('E')))
+        {
+            ++Cursor;
+            if (Cursor < End && (*Cursor == TEXT('+') || *Cursor == TEXT('-')))
             {
-                Message = MakeShared<FPingMessage>();
-                break;
+                ++Cursor;
             }
-            case ESignalRMessageType::Close:
-            {
-                TSharedPtr<FCloseMessage> CloseMessage = MakeShared<FCloseMessage>();
+            if (!ReadDigits(Cursor, false))
+                return false;
+        }
+        Pos = Cursor;
 
-                FString Error;
-                if (Obj->TryGetStringField(TEXT("error"), Error))
-                {
-                    CloseMessage->Error = Error;
-                }
+        TCHAR Buffer[64];
+        const int32 Length = (int32)(Pos - Start);
+        if (Length >= (int32)UE_ARRAY_COUNT(Buffer))
+        {
+            OutValue = FSignalRValue(FCString::Atod(*FString(Length, Start)));
+            return true;
+        }
+        FMemory::Memcpy(Buffer, Start, Length * sizeof(TCHAR));
+        Buffer[Length] = TEXT('\0');
+        OutValue = FSignalRValue(FCString::Atod(Buffer));
+        return true;
+    }
 
-                bool bAllowReconnect;
-                if (Obj->TryGetBoolField(TEXT("allowReconnect"), bAllowReconnect))
-                {
-                    CloseMessage->bAllowReconnect = bAllowReconnect;
-                }
+    static FORCEINLINE bool IsDigit(TCHAR InChar)
+    {
+        return InChar >= TEXT('0') && InChar <= TEXT('9');
+    }
 
-                Message = CloseMessage;
-                break;
-            }
-            default:
-                break;
-            }
+    /* at least one digit, bInteger also rejects leading zeros */
+    bool ReadDigits(const TCHAR*& Cursor, bool bInteger) const
+    {
+        if (Cursor >= End || !IsDigit(*Cursor))
+            return false;
+        if (bInteger && *Cursor == TEXT('0'))
+        {
+            ++Cursor;
+            return Cursor >= End || !IsDigit(*Cursor);
+        }
+        while (Cursor < End && IsDigit(*Cursor))
+        {
+            ++Cursor;
+        }
+        return true;
+    }
+
+    /* ports, ids and timestamps: plain integers are accumulated directly and kept lossless */
+    bool ReadInteger(FSignalRValue& OutValue)
+    {
+        const TCHAR* Cursor = Pos;
+        const bool bNegative = Cursor < End && *Cursor == TEXT('-');
+        if (bNegative)
+        {
+            ++Cursor;
+        }
+
+        const TCHAR* Digits = Cursor;
+        if (End - Cursor > 1 && Cursor[0] == TEXT('0') && IsDigit(Cursor[1]))
+            return false;//leading zero, rejected by ReadNumber
+
+        uint64 Magnitude = 0;
+        while (Cursor < End && IsDigit(*Cursor))
+        {
+            const uint64 Digit = *Cursor - TEXT('0');
+            if (Magnitude > (MAX_uint64 - Digit) / 10)
+                return false;
+            Magnitude = Magnitude * 10 + Digit;
+            ++Cursor;
+        }
+
+        // fractions, exponents and out of range values take the double path
+        if (Cursor == Digits || (Cursor < End && (*Cursor == TEXT('.') || *Cursor == TEXT('e') || *Cursor == TEXT('E'))))
+            return false;
 
-            return Message;
+        if (bNegative)
+        {
+            if (Magnitude > (uint64)MAX_int64 + 1)
+                return false;
+            OutValue = FSignalRValue((int64)(0 - Magnitude));
         }
+        else
+        {
+            OutValue = FSignalRValue(Magnitude);
+        }
+        Pos = Cursor;
+        return true;
+    }
+
+    bool ReadLiteral(const TCHAR* InLiteral)
+    {
+        const int32 Length = FCString::Strlen(InLiteral);
+        if (End - Pos < Length || FCString::Strncmp(Pos, InLiteral, Length) != 0)
+            return false;
+        Pos += Length;
+        return true;
     }
+
+    void SkipWhitespace()
+    {
+        while (Pos < End && (*Pos == TEXT(' ') || *Pos == TEXT('\t') || *Pos == TEXT('\r') || *Pos == TEXT('\n')))
+        {
+            ++Pos;
+        }
+    }
+
+    bool Peek(TCHAR InChar)
+    {
+        SkipWhitespace();
+        return Pos < End && *Pos == InChar;
+    }
+
+    bool Accept(TCHAR InChar)
+    {
+        if (!Peek(InChar))
+            return false;
+        ++Pos;
+        return true;
+    }
+
+    bool Expect(TCHAR InChar)
+    {
+        return Accept(InChar);
+    }
+
+    bool AtEnd()
+    {
+        SkipWhitespace();
+        return Pos == End;
+    }
+
+    const TCHAR* Pos;
+    const TCHAR* End;
+    bool bBorrowStrings;
+    int32 Depth = 0;//arguments and result are read at depth 0
+};
+
+/*
+ * Heap allocations per invocation record: the message, its exact size argument array, Target, and for each owned string
+ * argument longer than the inline storage a payload node and its buffer. Borrowed top level strings cost nothing.
+ * A per-frame arena could only have taken the payload nodes, so it is not used.
+ */
+TArray<TSharedPtr<FHubMessage>> FJsonHubProtocol::ParseMessages(const FString& InStr, bool bBorrowStrings) const
+{
+    DSSLITE_TRACE_SCOPE("DSSLite::Parse");
+
+    TArray<TSharedPtr<FHubMessage>> Messages;
+
+    // walk the frame in place instead of copying the remainder after every record
+    const TCHAR* Chars = *InStr;
+    const int32 Length = InStr.Len();
+    int32 Start = 0;
+    for (int32 Pos = 0; Pos < Length; ++Pos)
+    {
+        if (Chars[Pos] != RecordSeparator)
+            continue;
+
+        const FStringView Record(Chars + Start, Pos - Start);
+        TSharedPtr<FHubMessage> Message = FRecordReader(Record, bBorrowStrings).ReadMessage();
+        if (Message.IsValid())
+        {
+            TraceRecord(Message.Get(), Pos - Start + 1, false);
+            Messages.Add(MoveTemp(Message));
+        }
+        else
+        {
+            ReportInvalidMessage(FString(Record));
+        }
+        Start = Pos + 1;
+    }
+
+    return Messages;
+}
+
+void FJsonHubProtocol::ReportInvalidMessage(const FString& MessagePayload) const
+{
+    TSharedPtr<FJsonValue> JsonValue;
+    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(MessagePayload);
+    if (!FJsonSerializer::Deserialize(JsonReader, JsonValue))
+    {
+        UE_LOG(LogDSSLite, Error, TEXT("Cannot unserialize SignalR message: %s: %s"), *JsonReader->GetErrorMessage(), *MessagePayload);
+        return;
+    }
+    if (JsonValue->Type != EJson::Object)
+    {
+        UE_LOG(LogDSSLite, Error, TEXT("Message is not a 'object' type"));
+        return;
+    }
+
+    TSharedPtr<FJsonObject> Obj = JsonValue->AsObject();
+    if (!Obj->HasTypedField<EJson::Number>(TEXT("type")))
+    {
+        UE_LOG(LogDSSLite, Error, TEXT("Field 'type' not found in message %s"), *MessagePayload);
+        return;
+    }
+
+    switch (StaticCast<ESignalRMessageType>((int)Obj->GetNumberField(TEXT("type"))))
+    {
+    case ESignalRMessageType::Invocation:
+        if (!Obj->HasTypedField<EJson::String>(TEXT("target")))
+        {
+            UE_LOG(LogDSSLite, Error, TEXT("Field 'target' not found in invocation message %s"), *MessagePayload);
+            return;
+        }
+        if (!Obj->HasTypedField<EJson::Array>(TEXT("arguments")))
+        {
+            UE_LOG(LogDSSLite, Error, TEXT("Field 'arguments' not found in invocation message %s"), *MessagePayload);
+            return;
+        }
+        break;
+    case ESignalRMessageType::Completion:
+        if (!Obj->HasTypedField<EJson::String>(TEXT("invocationId")))
+        {
+            UE_LOG(LogDSSLite, Error, TEXT("Field 'invocationId' not found in completion message %s"), *MessagePayload);
+            return;
+        }
+        if (Obj->HasTypedField<EJson::String>(TEXT("error")) && !Obj->GetStringField(TEXT("error")).IsEmpty() && Obj->HasField(TEXT("result")))
+        {
+            UE_LOG(LogDSSLite, Error, TEXT("Fields 'error' and 'result' properties are mutually exclusive in completion message %s"), *MessagePayload);
+            return;
+        }
+        break;
+    case ESignalRMessageType::Ping:
+    case ESignalRMessageType::Close:
+        break;
+    default:
+        break;
+    }
+
+    UE_LOG(LogDSSLite, Error, TEXT("Cannot decode SignalR message %s"), *MessagePayload);
 }
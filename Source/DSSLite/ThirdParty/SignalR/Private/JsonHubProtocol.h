@@ -36,8 +36,9 @@ public:
     virtual int Version() const override;
 
     virtual FString SerializeMessage(const FHubMessage* InMessage) const override;
-    virtual TArray<TSharedPtr<FHubMessage>> ParseMessages(const FString&) const override;
+    virtual TArray<TSharedPtr<FHubMessage>> ParseMessages(const FString&, bool bBorrowStrings = false) const override;
 
 private:
-    TSharedPtr<FHubMessage> ParseMessage(const FString&) const;
+    /* the record reader rejected the record, parse it again with FJsonSerializer to log why */
+    void ReportInvalidMessage(const FString&) const;
 };
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020-2021 FrozenStorm Interactive
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SignalRValue.h"
+
+bool FSignalRValue::StringEquals(FStringView InOther, ESearchCase::Type SearchCase) const
+{
+    check(Type == EValueType::String);
+    if (InlineLength == HeapString)
+    {
+        return FStringView(static_cast<const TPayload<StringType>*>(GetPayload())->Value).Equals(InOther, SearchCase);
+    }
+    if (InlineLength == BorrowedString)
+    {
+        return GetBorrowedView().Equals(InOther, SearchCase);
+    }
+
+    if (InOther.Len() != InlineLength)
+        return false;
+
+    for (int32 Index = 0; Index < InlineLength; ++Index)
+    {
+        const TCHAR Char = (TCHAR)Data[Index];
+        const TCHAR OtherChar = InOther[Index];
+        if (SearchCase == ESearchCase::CaseSensitive ? Char != OtherChar : FChar::ToLower(Char) != FChar::ToLower(OtherChar))
+            return false;
+    }
+    return true;
+}
+
+void FSignalRValue::AppendString(FString& OutString) const
+{
+    check(Type == EValueType::String);
+    if (InlineLength == HeapString)
+    {
+        OutString += static_cast<const TPayload<StringType>*>(GetPayload())->Value;
+    }
+    else if (InlineLength == BorrowedString)
+    {
+        OutString += GetBorrowedView();
+    }
+    else
+    {
+        OutString.Reserve(OutString.Len() + InlineLength);
+        for (int32 Index = 0; Index < InlineLength; ++Index)
+        {
+            OutString.AppendChar((TCHAR)Data[Index]);
+        }
+    }
+}
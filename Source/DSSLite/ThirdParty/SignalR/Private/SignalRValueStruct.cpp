@@ -0,0 +1,582 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020-2021 FrozenStorm Interactive
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SignalRValue.h"
+#include "UObject/Class.h"
+#include "UObject/UnrealType.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/TextProperty.h"
+#include "Misc/ScopeLock.h"
+#include "DSSLiteLog.h"
+
+namespace
+{
+    enum class EFieldKind : uint8
+    {
+        Bool,
+        Int8,
+        Int16,
+        Int32,
+        Int64,
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Float,
+        Double,
+        Enum,
+        String,
+        Name,
+        Text,
+        Struct,
+        Array,
+        Binary,
+        Set,
+        Map,
+        Unsupported
+    };
+
+    struct FStructPlan;
+
+    /* how to read and write one value, resolved from its FProperty once */
+    struct FValuePlan
+    {
+        EFieldKind Kind = EFieldKind::Unsupported;
+        const FProperty* Property = nullptr;
+        const UEnum* Enum = nullptr;
+        TSharedPtr<const FStructPlan> Struct;
+        TUniquePtr<FValuePlan> Inner;
+        TUniquePtr<FValuePlan> Key;
+    };
+
+    struct FFieldPlan
+    {
+        FString Key;
+        int32 Offset = 0;
+        int32 ArrayDim = 1;
+        int32 ElementSize = 0;
+        FValuePlan Value;
+    };
+
+    struct FStructPlan
+    {
+        TArray<FFieldPlan> Fields;
+    };
+
+    TSharedPtr<const FStructPlan> GetStructPlan(const UScriptStruct* InStruct);
+
+    void BuildValuePlan(const FProperty* InProperty, FValuePlan& OutPlan)
+    {
+        OutPlan.Property = InProperty;
+
+        if (CastField<FBoolProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Bool;
+        }
+        else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Enum;
+            OutPlan.Property = EnumProperty->GetUnderlyingProperty();
+            OutPlan.Enum = EnumProperty->GetEnum();
+        }
+        else if (const FByteProperty* ByteProperty = CastField<FByteProperty>(InProperty))
+        {
+            OutPlan.Kind = ByteProperty->Enum != nullptr ? EFieldKind::Enum : EFieldKind::UInt8;
+            OutPlan.Enum = ByteProperty->Enum;
+        }
+        else if (CastField<FInt8Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Int8;
+        }
+        else if (CastField<FInt16Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Int16;
+        }
+        else if (CastField<FIntProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Int32;
+        }
+        else if (CastField<FInt64Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Int64;
+        }
+        else if (CastField<FUInt16Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::UInt16;
+        }
+        else if (CastField<FUInt32Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::UInt32;
+        }
+        else if (CastField<FUInt64Property>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::UInt64;
+        }
+        else if (CastField<FFloatProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Float;
+        }
+        else if (CastField<FDoubleProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Double;
+        }
+        else if (CastField<FStrProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::String;
+        }
+        else if (CastField<FNameProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Name;
+        }
+        else if (CastField<FTextProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Text;
+        }
+        else if (const FStructProperty* StructProperty = CastField<FStructProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Struct;
+            OutPlan.Struct = GetStructPlan(StructProperty->Struct);
+        }
+        else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(InProperty))
+        {
+            const FByteProperty* ByteInner = CastField<FByteProperty>(ArrayProperty->Inner);
+            if (ByteInner != nullptr && ByteInner->Enum == nullptr)
+            {
+                // TArray<uint8> goes over the wire as a binary blob
+                OutPlan.Kind = EFieldKind::Binary;
+            }
+            else
+            {
+                OutPlan.Kind = EFieldKind::Array;
+                OutPlan.Inner = MakeUnique<FValuePlan>();
+                BuildValuePlan(ArrayProperty->Inner, *OutPlan.Inner);
+            }
+        }
+        else if (const FSetProperty* SetProperty = CastField<FSetProperty>(InProperty))
+        {
+            OutPlan.Kind = EFieldKind::Set;
+            OutPlan.Inner = MakeUnique<FValuePlan>();
+            BuildValuePlan(SetProperty->ElementProp, *OutPlan.Inner);
+        }
+        else if (const FMapProperty* MapProperty = CastField<FMapProperty>(InProperty))
+        {
+            // objects only have string keys
+            if (CastField<FStrProperty>(MapProperty->KeyProp) || CastField<FNameProperty>(MapProperty->KeyProp))
+            {
+                OutPlan.Kind = EFieldKind::Map;
+                OutPlan.Key = MakeUnique<FValuePlan>();
+                BuildValuePlan(MapProperty->KeyProp, *OutPlan.Key);
+                OutPlan.Inner = MakeUnique<FValuePlan>();
+                BuildValuePlan(MapProperty->ValueProp, *OutPlan.Inner);
+            }
+        }
+
+        // containers of things we cannot represent are skipped as a whole
+        if (OutPlan.Inner.IsValid() && OutPlan.Inner->Kind == EFieldKind::Unsupported)
+        {
+            OutPlan.Kind = EFieldKind::Unsupported;
+        }
+    }
+
+    void BuildStructPlan(const UScriptStruct* InStruct, FStructPlan& OutPlan)
+    {
+        for (TFieldIterator<FProperty> It(InStruct); It; ++It)
+        {
+            FFieldPlan Field;
+            BuildValuePlan(*It, Field.Value);
+            if (Field.Value.Kind == EFieldKind::Unsupported)
+            {
+                UE_LOG(LogDSSLite, Verbose, TEXT("%s.%s has no SignalR representation and is skipped"), *InStruct->GetName(), *It->GetName());
+                continue;
+            }
+
+            // the server side serializer uses camelCase names
+            Field.Key = It->GetAuthoredName();
+            if (Field.Key.Len() > 0)
+            {
+                Field.Key[0] = FChar::ToLower(Field.Key[0]);
+            }
+            Field.Offset = It->GetOffset_ForInternal();
+            Field.ArrayDim = It->ArrayDim;
+            Field.ElementSize = It->ElementSize;
+            OutPlan.Fields.Add(MoveTemp(Field));
+        }
+
+        // in key order, building the object is then a plain append
+        OutPlan.Fields.Sort([](const FFieldPlan& A, const FFieldPlan& B) { return A.Key.Compare(B.Key, ESearchCase::IgnoreCase) < 0; });
+    }
+
+    FCriticalSection PlanCacheLock;
+    TMap<const UScriptStruct*, TSharedPtr<const FStructPlan>> PlanCache;
+
+    TSharedPtr<const FStructPlan> GetStructPlan(const UScriptStruct* InStruct)
+    {
+        // user defined structs can be recompiled with a new layout, only native ones are cached
+        if (!(InStruct->StructFlags & STRUCT_Native))
+        {
+            TSharedRef<FStructPlan> Plan = MakeShared<FStructPlan>();
+            BuildStructPlan(InStruct, *Plan);
+            return Plan;
+        }
+
+        FScopeLock Lock(&PlanCacheLock);
+        if (const TSharedPtr<const FStructPlan>* Plan = PlanCache.Find(InStruct))
+        {
+            return *Plan;
+        }
+
+        // cached before it is filled so structs holding arrays of themselves resolve to the same plan
+        TSharedRef<FStructPlan> Plan = MakeShared<FStructPlan>();
+        PlanCache.Add(InStruct, Plan);
+        BuildStructPlan(InStruct, *Plan);
+        return Plan;
+    }
+
+    FSignalRValue ReadStruct(const FStructPlan& InPlan, const uint8* InData);
+    bool WriteStruct(const FStructPlan& InPlan, const FSignalRValue& InValue, uint8* OutData);
+
+    FSignalRValue ReadValue(const FValuePlan& InPlan, const void* InData)
+    {
+        switch (InPlan.Kind)
+        {
+        case EFieldKind::Bool:
+            return FSignalRValue(static_cast<const FBoolProperty*>(InPlan.Property)->GetPropertyValue(InData));
+        case EFieldKind::Int8:
+            return FSignalRValue((int32)*static_cast<const int8*>(InData));
+        case EFieldKind::Int16:
+            return FSignalRValue((int32)*static_cast<const int16*>(InData));
+        case EFieldKind::Int32:
+            return FSignalRValue(*static_cast<const int32*>(InData));
+        case EFieldKind::Int64:
+            return FSignalRValue(*static_cast<const int64*>(InData));
+        case EFieldKind::UInt8:
+            return FSignalRValue((uint32)*static_cast<const uint8*>(InData));
+        case EFieldKind::UInt16:
+            return FSignalRValue((uint32)*static_cast<const uint16*>(InData));
+        case EFieldKind::UInt32:
+            return FSignalRValue(*static_cast<const uint32*>(InData));
+        case EFieldKind::UInt64:
+            return FSignalRValue(*static_cast<const uint64*>(InData));
+        case EFieldKind::Float:
+            return FSignalRValue(*static_cast<const float*>(InData));
+        case EFieldKind::Double:
+            return FSignalRValue(*static_cast<const double*>(InData));
+        case EFieldKind::Enum:
+            return FSignalRValue(static_cast<const FNumericProperty*>(InPlan.Property)->GetSignedIntPropertyValue(InData));
+        case EFieldKind::String:
+            return FSignalRValue(*static_cast<const FString*>(InData));
+        case EFieldKind::Name:
+            return FSignalRValue(static_cast<const FName*>(InData)->ToString());
+        case EFieldKind::Text:
+            return FSignalRValue(static_cast<const FText*>(InData)->ToString());
+        case EFieldKind::Struct:
+            return ReadStruct(*InPlan.Struct, static_cast<const uint8*>(InData));
+        case EFieldKind::Binary:
+            return FSignalRValue(*static_cast<const TArray<uint8>*>(InData));
+        case EFieldKind::Array:
+            {
+                FScriptArrayHelper Helper(static_cast<const FArrayProperty*>(InPlan.Property), InData);
+                TArray<FSignalRValue> Values;
+                Values.Reserve(Helper.Num());
+                for (int32 Index = 0; Index < Helper.Num(); ++Index)
+                {
+                    Values.Add(ReadValue(*InPlan.Inner, Helper.GetRawPtr(Index)));
+                }
+                return FSignalRValue(MoveTemp(Values));
+            }
+        case EFieldKind::Set:
+            {
+                FScriptSetHelper Helper(static_cast<const FSetProperty*>(InPlan.Property), InData);
+                TArray<FSignalRValue> Values;
+                Values.Reserve(Helper.Num());
+                for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+                {
+                    if (Helper.IsValidIndex(Index))
+                    {
+                        Values.Add(ReadValue(*InPlan.Inner, Helper.GetElementPtr(Index)));
+                    }
+                }
+                return FSignalRValue(MoveTemp(Values));
+            }
+        case EFieldKind::Map:
+            {
+                FScriptMapHelper Helper(static_cast<const FMapProperty*>(InPlan.Property), InData);
+                FSignalRObject Values;
+                Values.Reserve(Helper.Num());
+                for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+                {
+                    if (Helper.IsValidIndex(Index))
+                    {
+                        Values.Add(ReadValue(*InPlan.Key, Helper.GetKeyPtr(Index)).AsString(), ReadValue(*InPlan.Inner, Helper.GetValuePtr(Index)));
+                    }
+                }
+                return FSignalRValue(MoveTemp(Values));
+            }
+        default:
+            return FSignalRValue();
+        }
+    }
+
+    bool WriteValue(const FValuePlan& InPlan, const FSignalRValue& InValue, void* OutData)
+    {
+        switch (InPlan.Kind)
+        {
+        case EFieldKind::Bool:
+            if (!InValue.IsBoolean())
+                return false;
+            static_cast<const FBoolProperty*>(InPlan.Property)->SetPropertyValue(OutData, InValue.AsBool());
+            return true;
+        case EFieldKind::Int8:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<int8*>(OutData) = (int8)InValue.AsInt();
+            return true;
+        case EFieldKind::Int16:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<int16*>(OutData) = (int16)InValue.AsInt();
+            return true;
+        case EFieldKind::Int32:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<int32*>(OutData) = (int32)InValue.AsInt();
+            return true;
+        case EFieldKind::Int64:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<int64*>(OutData) = InValue.AsInt();
+            return true;
+        case EFieldKind::UInt8:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<uint8*>(OutData) = (uint8)InValue.AsUInt();
+            return true;
+        case EFieldKind::UInt16:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<uint16*>(OutData) = (uint16)InValue.AsUInt();
+            return true;
+        case EFieldKind::UInt32:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<uint32*>(OutData) = (uint32)InValue.AsUInt();
+            return true;
+        case EFieldKind::UInt64:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<uint64*>(OutData) = InValue.AsUInt();
+            return true;
+        case EFieldKind::Float:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<float*>(OutData) = InValue.AsFloat();
+            return true;
+        case EFieldKind::Double:
+            if (!InValue.IsDouble())
+                return false;
+            *static_cast<double*>(OutData) = InValue.AsDouble();
+            return true;
+        case EFieldKind::Enum:
+            {
+                int64 EnumValue;
+                if (InValue.IsDouble())
+                {
+                    EnumValue = InValue.AsInt();
+                }
+                else if (InValue.IsString())
+                {
+                    // accept names too, for servers using a string enum converter
+                    EnumValue = InPlan.Enum->GetValueByNameString(InValue.AsString());
+                    if (EnumValue == INDEX_NONE)
+                        return false;
+                }
+                else
+                {
+                    return false;
+                }
+                static_cast<const FNumericProperty*>(InPlan.Property)->SetIntPropertyValue(OutData, EnumValue);
+                return true;
+            }
+        case EFieldKind::String:
+            if (!InValue.IsString())
+                return false;
+            *static_cast<FString*>(OutData) = InValue.AsString();
+            return true;
+        case EFieldKind::Name:
+            if (!InValue.IsString())
+                return false;
+            *static_cast<FName*>(OutData) = FName(*InValue.AsString());
+            return true;
+        case EFieldKind::Text:
+            if (!InValue.IsString())
+                return false;
+            *static_cast<FText*>(OutData) = FText::FromString(InValue.AsString());
+            return true;
+        case EFieldKind::Struct:
+            return WriteStruct(*InPlan.Struct, InValue, static_cast<uint8*>(OutData));
+        case EFieldKind::Binary:
+            if (InValue.IsBinary())
+            {
+                *static_cast<TArray<uint8>*>(OutData) = InValue.AsBinary();
+                return true;
+            }
+            else if (InValue.IsArray())
+            {
+                TArray<uint8>& Bytes = *static_cast<TArray<uint8>*>(OutData);
+                Bytes.Reset(InValue.AsArray().Num());
+                for (const FSignalRValue& Byte : InValue.AsArray())
+                {
+                    if (!Byte.IsDouble())
+                        return false;
+                    Bytes.Add((uint8)Byte.AsUInt());
+                }
+                return true;
+            }
+            return false;
+        case EFieldKind::Array:
+            {
+                if (!InValue.IsArray())
+                    return false;
+                const TArray<FSignalRValue>& Values = InValue.AsArray();
+                FScriptArrayHelper Helper(static_cast<const FArrayProperty*>(InPlan.Property), OutData);
+                Helper.EmptyAndAddValues(Values.Num());
+                bool bSuccess = true;
+                for (int32 Index = 0; Index < Values.Num(); ++Index)
+                {
+                    bSuccess &= WriteValue(*InPlan.Inner, Values[Index], Helper.GetRawPtr(Index));
+                }
+                return bSuccess;
+            }
+        case EFieldKind::Set:
+            {
+                if (!InValue.IsArray())
+                    return false;
+                const TArray<FSignalRValue>& Values = InValue.AsArray();
+                FScriptSetHelper Helper(static_cast<const FSetProperty*>(InPlan.Property), OutData);
+                Helper.EmptyElements(Values.Num());
+                bool bSuccess = true;
+                for (const FSignalRValue& Value : Values)
+                {
+                    const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+                    bSuccess &= WriteValue(*InPlan.Inner, Value, Helper.GetElementPtr(Index));
+                }
+                Helper.Rehash();
+                return bSuccess;
+            }
+        case EFieldKind::Map:
+            {
+                if (!InValue.IsObject())
+                    return false;
+                const FSignalRObject& Values = InValue.AsSignalRObject();
+                FScriptMapHelper Helper(static_cast<const FMapProperty*>(InPlan.Property), OutData);
+                Helper.EmptyValues(Values.Num());
+                bool bSuccess = true;
+                for (const TPair<FString, FSignalRValue>& Pair : Values)
+                {
+                    const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+                    WriteValue(*InPlan.Key, FSignalRValue(Pair.Key), Helper.GetKeyPtr(Index));
+                    bSuccess &= WriteValue(*InPlan.Inner, Pair.Value, Helper.GetValuePtr(Index));
+                }
+                Helper.Rehash();
+                return bSuccess;
+            }
+        default:
+            return false;
+        }
+    }
+
+    FSignalRValue ReadStruct(const FStructPlan& InPlan, const uint8* InData)
+    {
+        FSignalRObject Values;
+        Values.Reserve(InPlan.Fields.Num());
+        for (const FFieldPlan& Field : InPlan.Fields)
+        {
+            const uint8* FieldData = InData + Field.Offset;
+            if (Field.ArrayDim == 1)
+            {
+                Values.Add(Field.Key, ReadValue(Field.Value, FieldData));
+            }
+            else
+            {
+                // fixed size C arrays
+                TArray<FSignalRValue> Elements;
+                Elements.Reserve(Field.ArrayDim);
+                for (int32 Index = 0; Index < Field.ArrayDim; ++Index)
+                {
+                    Elements.Add(ReadValue(Field.Value, FieldData + Index * Field.ElementSize));
+                }
+                Values.Add(Field.Key, FSignalRValue(MoveTemp(Elements)));
+            }
+        }
+        return FSignalRValue(MoveTemp(Values));
+    }
+
+    bool WriteStruct(const FStructPlan& InPlan, const FSignalRValue& InValue, uint8* OutData)
+    {
+        if (!InValue.IsObject())
+            return false;
+
+        const FSignalRObject& Values = InValue.AsSignalRObject();
+        bool bSuccess = true;
+        for (const FFieldPlan& Field : InPlan.Fields)
+        {
+            // keys compare case-insensitively, PascalCase keys are found as well
+            const FSignalRValue* Value = Values.Find(Field.Key);
+            if (Value == nullptr)
+                continue;
+
+            uint8* FieldData = OutData + Field.Offset;
+            if (Field.ArrayDim == 1)
+            {
+                bSuccess &= WriteValue(Field.Value, *Value, FieldData);
+            }
+            else if (Value->IsArray())
+            {
+                const TArray<FSignalRValue>& Elements = Value->AsArray();
+                const int32 Count = FMath::Min(Elements.Num(), Field.ArrayDim);
+                for (int32 Index = 0; Index < Count; ++Index)
+                {
+                    bSuccess &= WriteValue(Field.Value, Elements[Index], FieldData + Index * Field.ElementSize);
+                }
+            }
+            else
+            {
+                bSuccess = false;
+            }
+        }
+        return bSuccess;
+    }
+}
+
+FSignalRValue FSignalRValue::FromStruct(const UScriptStruct* InStruct, const void* InData)
+{
+    check(InStruct != nullptr && InData != nullptr);
+    return ReadStruct(*GetStructPlan(InStruct), static_cast<const uint8*>(InData));
+}
+
+bool FSignalRValue::ToStruct(const UScriptStruct* InStruct, void* OutData) const
+{
+    check(InStruct != nullptr && OutData != nullptr);
+    return WriteStruct(*GetStructPlan(InStruct), *this, static_cast<uint8*>(OutData));
+}
@@ -27,6 +27,25 @@
 #include "CoreMinimal.h"
 #include "SignalRValue.h"
 
+/**
+ * Counters collected by a hub connection since it was created.
+ */
+struct FHubConnectionStats
+{
+    uint64 BytesIn = 0;
+    uint64 BytesOut = 0;
+    uint64 FramesIn = 0;
+    uint64 FramesOut = 0;
+    uint64 RecordsIn = 0;
+    int32 RecordsPerFrame = 0;
+    double ParseTimeSeconds = 0;
+    double SerializeTimeSeconds = 0;
+    int32 QueueDepth = 0;
+    int32 PendingInvocations = 0;
+    int32 ReconnectCount = 0;
+    double InvokeRTTSeconds = -1;//last Invoke to completion round trip
+};
+
 class DSSLITE_API IHubConnection : public TSharedFromThis<IHubConnection>
 {
 public:
@@ -55,6 +74,12 @@ public:
     DECLARE_DELEGATE_OneParam(FOnMethodInvocation, const TArray<FSignalRValue>&);
     virtual FOnMethodInvocation& On(FName EventName) = 0;
 
+    /**
+     * Removes the handler registered with On, the event can then be bound again.
+     * Does nothing by default so existing implementations keep compiling.
+     */
+    virtual void Off(FName EventName) {}
+
     DECLARE_DELEGATE_OneParam(FOnMethodCompletion, const FSignalRValue&);
     virtual FOnMethodCompletion& Invoke(FName EventName, const TArray<FSignalRValue>& InArguments = TArray<FSignalRValue>()) = 0;
 
@@ -78,6 +103,34 @@ public:
     {
         return false;
     }
+
+    /**
+     * True from Start until the handshake completes or the connection fails.
+     */
+    virtual bool IsConnecting()
+    {
+        return false;
+    }
+
+    /**
+     * Returns a snapshot of the connection counters.
+     */
+    virtual FHubConnectionStats GetStats() const
+    {
+        return FHubConnectionStats();
+    }
+
+    /**
+     * Appends every inbound and outbound frame to a traffic log that FHubTrafficReplayer can play back.
+     */
+    virtual bool StartRecording(const FString& InFilename)
+    {
+        return false;
+    }
+
+    virtual void StopRecording()
+    {
+    }
     
 protected:
 
@@ -25,12 +25,279 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Misc/TVariant.h"
+#include "Containers/StringView.h"
 
+class UScriptStruct;
+
+/**
+ * Key/value storage of an object value. Most objects have a handful of keys, they are kept as one sorted array
+ * searched in place. Past HashThreshold keys a hash index is built on top and new keys are appended.
+ * Keys compare case-insensitively, like FString map keys.
+ */
+template<typename ValueType>
+class TSignalRObject
+{
+public:
+    using FEntry = TPair<FString, ValueType>;
+
+    static constexpr int32 HashThreshold = 16;
+
+    TSignalRObject() = default;
+
+    TSignalRObject(const TMap<FString, ValueType>& InValues)
+    {
+        Reserve(InValues.Num());
+        for (const TPair<FString, ValueType>& Pair : InValues)
+        {
+            Add(Pair.Key, Pair.Value);
+        }
+    }
+
+    TSignalRObject(TMap<FString, ValueType>&& InValues)
+    {
+        Reserve(InValues.Num());
+        for (TPair<FString, ValueType>& Pair : InValues)
+        {
+            Add(MoveTemp(Pair.Key), MoveTemp(Pair.Value));
+        }
+        InValues.Reset();
+    }
+
+    FORCEINLINE int32 Num() const
+    {
+        return Entries.Num();
+    }
+
+    FORCEINLINE bool IsEmpty() const
+    {
+        return Entries.Num() == 0;
+    }
+
+    void Reserve(int32 InNumber)
+    {
+        Entries.Reserve(InNumber);
+    }
+
+    /**
+     * Adds or replaces the value stored under InKey.
+     */
+    template<typename KeyArgType, typename ValueArgType>
+    ValueType& Add(KeyArgType&& InKey, ValueArgType&& InValue)
+    {
+        const FStringView Key(InKey);
+        int32 EntryIndex;
+        if (Index.Num() > 0)
+        {
+            EntryIndex = FindIndexHashed(Key);
+            if (EntryIndex == INDEX_NONE)
+            {
+                EntryIndex = Entries.Emplace(Forward<KeyArgType>(InKey), Forward<ValueArgType>(InValue));
+                AddToIndex(EntryIndex);
+                return Entries[EntryIndex].Value;
+            }
+        }
+        else
+        {
+            // in order adds, like decoding our own sorted output, append without a search
+            EntryIndex = Entries.Num() > 0 && Compare(Entries.Last().Key, Key) >= 0 ? LowerBound(Key) : Entries.Num();
+            if (!Entries.IsValidIndex(EntryIndex) || Compare(Entries[EntryIndex].Key, Key) != 0)
+            {
+                Entries.EmplaceAt(EntryIndex, Forward<KeyArgType>(InKey), Forward<ValueArgType>(InValue));
+                if (Entries.Num() > HashThreshold)
+                {
+                    BuildIndex();
+                }
+                return Entries[EntryIndex].Value;
+            }
+        }
+
+        Entries[EntryIndex].Value = Forward<ValueArgType>(InValue);
+        return Entries[EntryIndex].Value;
+    }
+
+    const ValueType* Find(FStringView InKey) const
+    {
+        const int32 EntryIndex = FindIndex(InKey);
+        return EntryIndex != INDEX_NONE ? &Entries[EntryIndex].Value : nullptr;
+    }
+
+    ValueType* Find(FStringView InKey)
+    {
+        const int32 EntryIndex = FindIndex(InKey);
+        return EntryIndex != INDEX_NONE ? &Entries[EntryIndex].Value : nullptr;
+    }
+
+    FORCEINLINE bool Contains(FStringView InKey) const
+    {
+        return FindIndex(InKey) != INDEX_NONE;
+    }
+
+    /**
+     * Returns a copy of the value stored under InKey, or a default constructed value, like TMap::FindRef.
+     */
+    ValueType FindRef(FStringView InKey) const
+    {
+        const ValueType* Value = Find(InKey);
+        return Value != nullptr ? *Value : ValueType();
+    }
+
+    /**
+     * Fills OutKeys with the keys in iteration order and returns their number, like TMap::GetKeys.
+     */
+    int32 GetKeys(TArray<FString>& OutKeys) const
+    {
+        OutKeys.Reset(Entries.Num());
+        for (const FEntry& Entry : Entries)
+        {
+            OutKeys.Add(Entry.Key);
+        }
+        return OutKeys.Num();
+    }
+
+    const ValueType& FindChecked(FStringView InKey) const
+    {
+        const ValueType* Value = Find(InKey);
+        check(Value != nullptr);
+        return *Value;
+    }
+
+    FORCEINLINE const ValueType& operator[](FStringView InKey) const
+    {
+        return FindChecked(InKey);
+    }
+
+    TMap<FString, ValueType> ToMap() const
+    {
+        TMap<FString, ValueType> Values;
+        Values.Reserve(Entries.Num());
+        for (const FEntry& Entry : Entries)
+        {
+            Values.Add(Entry.Key, Entry.Value);
+        }
+        return Values;
+    }
+
+    FORCEINLINE auto begin() const { return Entries.begin(); }
+    FORCEINLINE auto end() const { return Entries.end(); }
+    FORCEINLINE auto begin() { return Entries.begin(); }
+    FORCEINLINE auto end() { return Entries.end(); }
+
+private:
+    static FORCEINLINE int32 Compare(FStringView A, FStringView B)
+    {
+        return A.Compare(B, ESearchCase::IgnoreCase);
+    }
+
+    /* crc of the lowercased key, in small chunks so nothing is allocated */
+    static uint32 HashKey(FStringView InKey)
+    {
+        constexpr int32 ChunkSize = 64;
+        TCHAR Lowered[ChunkSize];
+        uint32 Hash = 0;
+        for (int32 Start = 0; Start < InKey.Len(); Start += ChunkSize)
+        {
+            const int32 Count = FMath::Min(InKey.Len() - Start, ChunkSize);
+            for (int32 CharIndex = 0; CharIndex < Count; ++CharIndex)
+            {
+                Lowered[CharIndex] = FChar::ToLower(InKey[Start + CharIndex]);
+            }
+            Hash = FCrc::MemCrc32(Lowered, Count * (int32)sizeof(TCHAR), Hash);
+        }
+        return Hash;
+    }
+
+    int32 LowerBound(FStringView InKey) const
+    {
+        int32 First = 0;
+        int32 Count = Entries.Num();
+        while (Count > 0)
+        {
+            const int32 Step = Count / 2;
+            if (Compare(Entries[First + Step].Key, InKey) < 0)
+            {
+                First += Step + 1;
+                Count -= Step + 1;
+            }
+            else
+            {
+                Count = Step;
+            }
+        }
+        return First;
+    }
+
+    int32 FindIndex(FStringView InKey) const
+    {
+        if (Index.Num() > 0)
+        {
+            return FindIndexHashed(InKey);
+        }
+
+        const int32 EntryIndex = LowerBound(InKey);
+        return Entries.IsValidIndex(EntryIndex) && Compare(Entries[EntryIndex].Key, InKey) == 0 ? EntryIndex : INDEX_NONE;
+    }
+
+    int32 FindIndexHashed(FStringView InKey) const
+    {
+        const uint32 Mask = Index.Num() - 1;
+        for (uint32 Slot = HashKey(InKey) & Mask; Index[Slot] != 0; Slot = (Slot + 1) & Mask)
+        {
+            const int32 EntryIndex = Index[Slot] - 1;
+            if (Compare(Entries[EntryIndex].Key, InKey) == 0)
+                return EntryIndex;
+        }
+        return INDEX_NONE;
+    }
+
+    void AddToIndex(int32 InEntryIndex)
+    {
+        // keep the load factor under one half
+        if (Entries.Num() * 2 > Index.Num())
+        {
+            BuildIndex();
+            return;
+        }
+
+        const uint32 Mask = Index.Num() - 1;
+        uint32 Slot = HashKey(Entries[InEntryIndex].Key) & Mask;
+        while (Index[Slot] != 0)
+        {
+            Slot = (Slot + 1) & Mask;
+        }
+        Index[Slot] = InEntryIndex + 1;
+    }
+
+    void BuildIndex()
+    {
+        Index.Reset();
+        Index.SetNumZeroed((int32)FMath::RoundUpToPowerOfTwo(Entries.Num() * 4));
+        const uint32 Mask = Index.Num() - 1;
+        for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+        {
+            uint32 Slot = HashKey(Entries[EntryIndex].Key) & Mask;
+            while (Index[Slot] != 0)
+            {
+                Slot = (Slot + 1) & Mask;
+            }
+            Index[Slot] = EntryIndex + 1;
+        }
+    }
+
+    TArray<FEntry> Entries;
+
+    /* open addressing, entry index + 1 and 0 for empty slots. Only used past HashThreshold */
+    TArray<int32> Index;
+};
+
+/**
+ * 16 byte value. Numbers (64 bit integers or doubles), booleans and short ASCII strings are stored inline, larger strings, arrays, objects
+ * and binary blobs live in a refcounted payload shared between copies.
+ * Decoded string arguments may borrow from the received frame, copying them or calling Persist() makes an owned copy.
+ */
 class DSSLITE_API FSignalRValue
 {
 public:
-    enum class EValueType
+    enum class EValueType : uint8
     {
         Number,
         Object,
@@ -45,6 +312,7 @@ public:
      * Create an object representing a EValueType::Null value.
      */
     FSignalRValue() :
+        InlineLength(0),
         Type(EValueType::Null)
     {
     }
@@ -53,140 +321,179 @@ public:
      * Create an object representing a EValueType::Null value.
      */
     FSignalRValue(std::nullptr_t) :
+        InlineLength(0),
         Type(EValueType::Null)
     {
     }
 
-    FSignalRValue(const int32 InValue) :
-        Type(EValueType::Number)
+    /**
+     * Integers are stored as 64 bit integers, they round trip without going through a double.
+     */
+    FSignalRValue(const int32 InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetInteger(InValue, SignedNumber);
     }
 
-    FSignalRValue(const uint32 InValue) :
-        Type(EValueType::Number)
+    FSignalRValue(const uint32 InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetInteger(InValue, SignedNumber);
     }
 
-    FSignalRValue(const int64 InValue) :
-        Type(EValueType::Number)
+    FSignalRValue(const int64 InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetInteger(InValue, SignedNumber);
     }
 
-    FSignalRValue(const uint64 InValue) :
-        Type(EValueType::Number)
+    FSignalRValue(const uint64 InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetInteger((int64)InValue, InValue > (uint64)MAX_int64 ? UnsignedNumber : SignedNumber);
     }
 
     /**
      * Create an object representing a EValueType::Float with the given float value.
      */
-    FSignalRValue(const float InValue) :
-        Type(EValueType::Number)
+    FSignalRValue(const float InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetNumber(InValue);
     }
 
     /**
      * Create an object representing a EValueType::Double with the given double value.
      */
-    FSignalRValue(const double InValue) :
-        Type(EValueType::Number)
+    FSignalRValue(const double InValue)
     {
-        Value.Set<NumberType>(InValue);
+        SetNumber(InValue);
     }
 
     /**
      * Create an object representing a EValueType::Object with the given map of string-value's.
      */
-    FSignalRValue(const TMap<FString, FSignalRValue>& InValue) :
-        Type(EValueType::Object)
+    FSignalRValue(const TMap<FString, FSignalRValue>& InValue)
     {
-        Value.Set<TSharedPtr<ObjectType>>(MakeShared<ObjectType>(InValue));
+        SetPayload(EValueType::Object, new FObjectPayload(InValue));
     }
 
     /**
      * Create an object representing a EValueType::Object with the given map of string-value's.
      */
-    FSignalRValue(TMap<FString, FSignalRValue>&& InValue) :
-        Type(EValueType::Object)
+    FSignalRValue(TMap<FString, FSignalRValue>&& InValue)
+    {
+        SetPayload(EValueType::Object, new FObjectPayload(MoveTemp(InValue)));
+    }
+
+    /**
+     * Create an object representing a EValueType::Object with the given object.
+     */
+    FSignalRValue(const TSignalRObject<FSignalRValue>& InValue)
     {
-        Value.Emplace<TSharedPtr<ObjectType>>(MakeShared<ObjectType>(MoveTemp(InValue)));
+        SetPayload(EValueType::Object, new FObjectPayload(InValue));
+    }
+
+    /**
+     * Create an object representing a EValueType::Object with the given object.
+     */
+    FSignalRValue(TSignalRObject<FSignalRValue>&& InValue)
+    {
+        SetPayload(EValueType::Object, new FObjectPayload(MoveTemp(InValue)));
     }
 
     /**
      * Create an object representing a EValueType::Array with the given array of value's.
      */
-    FSignalRValue(const TArray<FSignalRValue>& InValue) :
-        Type(EValueType::Array)
+    FSignalRValue(const TArray<FSignalRValue>& InValue)
     {
-        Value.Set<ArrayType>(InValue);
+        SetPayload(EValueType::Array, new TPayload<ArrayType>(InValue));
     }
 
     /**
      * Create an object representing a EValueType::Array with the given array of value's.
      */
-    FSignalRValue(TArray<FSignalRValue>&& InValue) :
-        Type(EValueType::Array)
+    FSignalRValue(TArray<FSignalRValue>&& InValue)
     {
-        Value.Emplace<ArrayType>(InValue);
+        SetPayload(EValueType::Array, new TPayload<ArrayType>(MoveTemp(InValue)));
     }
 
     /**
      * Create an object representing a EValueType::String with the given string value.
      */
-    FSignalRValue(const FString& InValue) :
-        Type(EValueType::String)
+    FSignalRValue(const FString& InValue)
     {
-        Value.Set<StringType>(InValue);
+        if (!SetInlineString(InValue))
+        {
+            SetPayload(EValueType::String, new TPayload<StringType>(InValue));
+        }
     }
 
     /**
      * Create an object representing a EValueType::String with the given string value.
      */
-    FSignalRValue(FString&& InValue) :
-        Type(EValueType::String)
+    FSignalRValue(FString&& InValue)
     {
-        Value.Emplace<StringType>(MoveTemp(InValue));
+        if (!SetInlineString(InValue))
+        {
+            SetPayload(EValueType::String, new TPayload<StringType>(MoveTemp(InValue)));
+        }
     }
 
     /**
      * Create an object representing a EValueType::Boolean with the given bool value.
      */
     FSignalRValue(bool InValue) :
+        InlineLength(0),
         Type(EValueType::Boolean)
     {
-        Value.Set<BooleanType>(InValue);
+        Data[0] = InValue ? 1 : 0;
     }
 
     /**
      * Create an object representing a value_type::binary with the given array of byte's.
      */
-    FSignalRValue(const TArray<uint8>& InValue) :
-        Type(EValueType::Binary)
+    FSignalRValue(const TArray<uint8>& InValue)
     {
-        Value.Set<BinaryType>(InValue);
+        SetPayload(EValueType::Binary, new TPayload<BinaryType>(InValue));
     }
 
     /**
      * Create an object representing a value_type::binary with the given array of byte's.
      */
-    FSignalRValue(TArray<uint8>&& InValue) :
-        Type(EValueType::Binary)
+    FSignalRValue(TArray<uint8>&& InValue)
+    {
+        SetPayload(EValueType::Binary, new TPayload<BinaryType>(MoveTemp(InValue)));
+    }
+
+    /**
+     * Create a string value pointing at InValue without copying it, the characters must outlive the value.
+     * Short ASCII strings are still stored inline.
+     */
+    static FSignalRValue Borrow(FStringView InValue)
     {
-        Value.Emplace<BinaryType>(MoveTemp(InValue));
+        FSignalRValue Value;
+        if (!Value.SetInlineString(InValue))
+        {
+            const TCHAR* Chars = InValue.GetData();
+            const int32 Length = InValue.Len();
+            FMemory::Memcpy(Value.Data, &Chars, sizeof(Chars));
+            FMemory::Memcpy(Value.Data + sizeof(Chars), &Length, sizeof(Length));
+            Value.InlineLength = BorrowedString;
+            Value.Type = EValueType::String;
+        }
+        return Value;
     }
 
     /**
-     * Copies an existing value.
+     * Copies an existing value, payloads are shared unless they are borrowed.
      */
     FSignalRValue(const FSignalRValue& OtherValue)
     {
-        Type = OtherValue.Type;
-        Value = OtherValue.Value;
+        if (OtherValue.IsBorrowed())
+        {
+            InlineLength = 0;
+            Type = EValueType::Null;
+            *this = OtherValue.Persist();
+            return;
+        }
+        CopyBits(OtherValue);
+        AddRef();
     }
 
     /**
@@ -194,22 +501,34 @@ public:
      */
     FSignalRValue(FSignalRValue&& OtherValue) noexcept
     {
-        Type = MoveTemp(OtherValue.Type);
-        Value = MoveTemp(OtherValue.Value);
+        CopyBits(OtherValue);
+        OtherValue.InlineLength = 0;
+        OtherValue.Type = EValueType::Null;
     }
 
     /**
      * Cleans up the resources associated with the value.
      */
-    ~FSignalRValue() = default;
+    ~FSignalRValue()
+    {
+        Release();
+    }
 
     /**
-     * Copies an existing value.
+     * Copies an existing value, payloads are shared.
      */
     FSignalRValue& operator=(const FSignalRValue& OtherValue)
     {
-        Type = OtherValue.Type;
-        Value = OtherValue.Value;
+        if (OtherValue.IsBorrowed())
+        {
+            return *this = OtherValue.Persist();
+        }
+        if (this != &OtherValue)
+        {
+            OtherValue.AddRef();
+            Release();
+            CopyBits(OtherValue);
+        }
         return *this;
     }
 
@@ -218,13 +537,58 @@ public:
      */
     FSignalRValue& operator=(FSignalRValue&& OtherValue) noexcept
     {
-        Type = MoveTemp(OtherValue.Type);
-        Value = MoveTemp(OtherValue.Value);
+        if (this != &OtherValue)
+        {
+            Release();
+            CopyBits(OtherValue);
+            OtherValue.InlineLength = 0;
+            OtherValue.Type = EValueType::Null;
+        }
         return *this;
     }
 
     /**
-     * True if the object stored is a double.
+     * Returns a copy that does not reference the received frame, for values kept past the handler that received them.
+     */
+    FORCEINLINE FSignalRValue Persist() const
+    {
+        return IsBorrowed() ? FSignalRValue(AsString()) : *this;
+    }
+
+    /**
+     * True if the value is a string only valid while the frame it was decoded from is being dispatched.
+     */
+    FORCEINLINE bool IsBorrowed() const
+    {
+        return Type == EValueType::String && InlineLength == BorrowedString;
+    }
+
+    /**
+     * Converts a reflected struct to a EValueType::Object, keys are the camelCased property names.
+     * Property layouts are compiled once per struct type, repeat conversions only walk the cached offsets.
+     */
+    static FSignalRValue FromStruct(const UScriptStruct* InStruct, const void* InData);
+
+    template<typename StructType>
+    static FSignalRValue FromStruct(const StructType& InValue)
+    {
+        return FromStruct(StructType::StaticStruct(), &InValue);
+    }
+
+    /**
+     * Fills a reflected struct from a EValueType::Object, keys match case-insensitively and missing keys leave the field untouched.
+     * Returns false if this is not an object or a field had a mismatched type.
+     */
+    bool ToStruct(const UScriptStruct* InStruct, void* OutData) const;
+
+    template<typename StructType>
+    bool ToStruct(StructType& OutValue) const
+    {
+        return ToStruct(StructType::StaticStruct(), &OutValue);
+    }
+
+    /**
+     * True if the object stored is a number, integer or double.
      */
     FORCEINLINE bool IsDouble() const
     {
@@ -284,22 +648,46 @@ public:
         return Type;
     }
 
+    /**
+     * True if the number stored is an integer, AsInt and AsUInt return it as is.
+     */
+    FORCEINLINE bool IsInteger() const
+    {
+        return Type == EValueType::Number && InlineLength != DoubleNumber;
+    }
+
+    /**
+     * True if the integer stored is above MAX_int64, only AsUInt returns it unchanged.
+     */
+    FORCEINLINE bool IsUnsigned() const
+    {
+        return Type == EValueType::Number && InlineLength == UnsignedNumber;
+    }
+
     FORCEINLINE int64 AsInt() const
     {
         check(Type == EValueType::Number);
-        return Value.Get<NumberType>();
+        if (InlineLength != DoubleNumber)
+        {
+            return GetInteger();
+        }
+        return (int64)GetDouble();
     }
 
     FORCEINLINE uint64 AsUInt() const
     {
         check(Type == EValueType::Number);
-        return Value.Get<NumberType>();
+        if (InlineLength != DoubleNumber)
+        {
+            return (uint64)GetInteger();
+        }
+        return (uint64)GetDouble();
     }
 
     FORCEINLINE float AsFloat() const
     {
         check(Type == EValueType::Number);
-        return Value.Get<NumberType>();
+        return (float)GetNumber();
     }
 
     /**
@@ -308,7 +696,7 @@ public:
     FORCEINLINE double AsDouble() const
     {
         check(Type == EValueType::Number);
-        return Value.Get<NumberType>();
+        return GetNumber();
     }
 
     /**
@@ -317,16 +705,41 @@ public:
     FORCEINLINE double AsNumber() const
     {
         check(Type == EValueType::Number);
-        return Value.Get<NumberType>();
+        return GetNumber();
     }
 
     /**
      * Returns the stored object as a map of property name to value. This will throw if the underlying object is not a EValueType::Object.
+     * The map is built from the flat storage on first use and kept with the value, AsSignalRObject() reads the storage directly.
      */
-    FORCEINLINE const TMap<FString, FSignalRValue>& AsObject() const
+    const TMap<FString, FSignalRValue>& AsObject() const
     {
         check(Type == EValueType::Object);
-        return *Value.Get<TSharedPtr<ObjectType>>();
+        const FObjectPayload* Payload = static_cast<const FObjectPayload*>(GetPayload());
+        if (TMap<FString, FSignalRValue>* Map = Payload->Map.Load())
+        {
+            return *Map;
+        }
+
+        // values are immutable once built, another thread may race us to the same map
+        TMap<FString, FSignalRValue>* NewMap = new TMap<FString, FSignalRValue>(Payload->Value.ToMap());
+        TMap<FString, FSignalRValue>* Expected = nullptr;
+        if (!Payload->Map.CompareExchange(Expected, NewMap))
+        {
+            delete NewMap;
+            return *Expected;
+        }
+        return *NewMap;
+    }
+
+    /**
+     * Returns the stored object's key/value storage. This will throw if the underlying object is not a EValueType::Object.
+     * It has the TMap read API (Find, FindRef, Contains, Num, GetKeys, ranged for over Key/Value pairs) without building a map.
+     */
+    FORCEINLINE const TSignalRObject<FSignalRValue>& AsSignalRObject() const
+    {
+        check(Type == EValueType::Object);
+        return static_cast<const FObjectPayload*>(GetPayload())->Value;
     }
 
     /**
@@ -335,25 +748,43 @@ public:
     FORCEINLINE const TArray<FSignalRValue>& AsArray() const
     {
         check(Type == EValueType::Array);
-        return Value.Get<ArrayType>();
+        return static_cast<const TPayload<ArrayType>*>(GetPayload())->Value;
     }
 
     /**
-     * Returns the stored object as a string. This will throw if the underlying object is not a EValueType::String.
+     * Returns a copy of the stored string. This will throw if the underlying object is not a EValueType::String.
      */
-    FORCEINLINE const FString& AsString() const
+    FORCEINLINE FString AsString() const
     {
         check(Type == EValueType::String);
-        return Value.Get<StringType>();
+        if (InlineLength == HeapString)
+        {
+            return static_cast<const TPayload<StringType>*>(GetPayload())->Value;
+        }
+        if (InlineLength == BorrowedString)
+        {
+            return FString(GetBorrowedView());
+        }
+        return FString(InlineLength, reinterpret_cast<const ANSICHAR*>(Data));
     }
 
+    /**
+     * Compares the stored string without copying it. This will throw if the underlying object is not a EValueType::String.
+     */
+    bool StringEquals(FStringView InOther, ESearchCase::Type SearchCase = ESearchCase::CaseSensitive) const;
+
+    /**
+     * Appends the stored string to OutString without an intermediate copy. This will throw if the underlying object is not a EValueType::String.
+     */
+    void AppendString(FString& OutString) const;
+
     /**
      * Returns the stored object a boolean. This will throw if the underlying object is not a EValueType::Boolean.
      */
     FORCEINLINE bool AsBool() const
     {
         check(Type == EValueType::Boolean);
-        return Value.Get<BooleanType>();
+        return Data[0] != 0;
     }
 
     /**
@@ -362,19 +793,192 @@ public:
     FORCEINLINE const TArray<uint8>& AsBinary() const
     {
         check(Type == EValueType::Binary);
-        return Value.Get<BinaryType>();
+        return static_cast<const TPayload<BinaryType>*>(GetPayload())->Value;
     }
 
 private:
-    EValueType Type;
-
     using NumberType = double;
-    using ObjectType = TMap<FString, FSignalRValue>;
+    using ObjectType = TSignalRObject<FSignalRValue>;
     using ArrayType = TArray<FSignalRValue>;
     using StringType = FString;
-    using BooleanType = bool;
     using BinaryType = TArray<uint8>;
-    using FInternalValueVariant = TVariant<NumberType, TSharedPtr<ObjectType>, ArrayType, StringType, BooleanType, BinaryType>;
 
-    FInternalValueVariant Value;
+    struct FPayload
+    {
+        TAtomic<int32> RefCount { 1 };
+    };
+
+    template<typename T>
+    struct TPayload : FPayload
+    {
+        template<typename ArgType>
+        explicit TPayload(ArgType&& InValue) :
+            Value(Forward<ArgType>(InValue))
+        {
+        }
+
+        T Value;
+    };
+
+    struct FObjectPayload : TPayload<ObjectType>
+    {
+        using TPayload<ObjectType>::TPayload;
+
+        ~FObjectPayload()
+        {
+            delete Map.Load();
+        }
+
+        /* built by AsObject() */
+        mutable TAtomic<TMap<FString, FSignalRValue>*> Map { nullptr };
+    };
+
+    /* player names and short ids fit, longer or non ASCII strings go to a payload */
+    static constexpr int32 MaxInlineLength = 14;
+    static constexpr uint8 HeapString = 0xFF;
+    static constexpr uint8 BorrowedString = 0xFE;//pointer and length into a frame
+
+    /* numbers keep their representation in InlineLength */
+    static constexpr uint8 DoubleNumber = 0;
+    static constexpr uint8 SignedNumber = 1;
+    static constexpr uint8 UnsignedNumber = 2;//uint64 above MAX_int64
+
+    FORCEINLINE bool HasPayload() const
+    {
+        return Type == EValueType::Object || Type == EValueType::Array || Type == EValueType::Binary || (Type == EValueType::String && InlineLength == HeapString);
+    }
+
+    FORCEINLINE FPayload* GetPayload() const
+    {
+        FPayload* Payload;
+        FMemory::Memcpy(&Payload, Data, sizeof(Payload));
+        return Payload;
+    }
+
+    FORCEINLINE void SetPayload(EValueType InType, FPayload* InPayload)
+    {
+        FMemory::Memcpy(Data, &InPayload, sizeof(InPayload));
+        InlineLength = InType == EValueType::String ? HeapString : 0;
+        Type = InType;
+    }
+
+    FORCEINLINE double GetDouble() const
+    {
+        NumberType Number;
+        FMemory::Memcpy(&Number, Data, sizeof(Number));
+        return Number;
+    }
+
+    FORCEINLINE int64 GetInteger() const
+    {
+        int64 Number;
+        FMemory::Memcpy(&Number, Data, sizeof(Number));
+        return Number;
+    }
+
+    FORCEINLINE double GetNumber() const
+    {
+        switch (InlineLength)
+        {
+        case SignedNumber:
+            return (double)GetInteger();
+        case UnsignedNumber:
+            return (double)(uint64)GetInteger();
+        default:
+            return GetDouble();
+        }
+    }
+
+    FORCEINLINE void SetNumber(NumberType InValue)
+    {
+        FMemory::Memcpy(Data, &InValue, sizeof(InValue));
+        InlineLength = DoubleNumber;
+        Type = EValueType::Number;
+    }
+
+    FORCEINLINE void SetInteger(int64 InValue, uint8 InKind)
+    {
+        FMemory::Memcpy(Data, &InValue, sizeof(InValue));
+        InlineLength = InKind;
+        Type = EValueType::Number;
+    }
+
+    FORCEINLINE FStringView GetBorrowedView() const
+    {
+        const TCHAR* Chars;
+        int32 Length;
+        FMemory::Memcpy(&Chars, Data, sizeof(Chars));
+        FMemory::Memcpy(&Length, Data + sizeof(Chars), sizeof(Length));
+        return FStringView(Chars, Length);
+    }
+
+    FORCEINLINE bool SetInlineString(FStringView InValue)
+    {
+        const int32 Length = InValue.Len();
+        if (Length > MaxInlineLength)
+            return false;
+
+        const TCHAR* Chars = InValue.GetData();
+        for (int32 Index = 0; Index < Length; ++Index)
+        {
+            if (Chars[Index] > 0x7F)
+                return false;
+            Data[Index] = (uint8)Chars[Index];
+        }
+        InlineLength = (uint8)Length;
+        Type = EValueType::String;
+        return true;
+    }
+
+    FORCEINLINE void CopyBits(const FSignalRValue& OtherValue)
+    {
+        FMemory::Memcpy(Data, OtherValue.Data, sizeof(Data));
+        InlineLength = OtherValue.InlineLength;
+        Type = OtherValue.Type;
+    }
+
+    FORCEINLINE void AddRef() const
+    {
+        if (HasPayload())
+        {
+            ++GetPayload()->RefCount;
+        }
+    }
+
+    void Release()
+    {
+        if (!HasPayload())
+            return;
+
+        FPayload* Payload = GetPayload();
+        if (--Payload->RefCount != 0)
+            return;
+
+        switch (Type)
+        {
+        case EValueType::Object:
+            delete static_cast<FObjectPayload*>(Payload);
+            break;
+        case EValueType::Array:
+            delete static_cast<TPayload<ArrayType>*>(Payload);
+            break;
+        case EValueType::String:
+            delete static_cast<TPayload<StringType>*>(Payload);
+            break;
+        case EValueType::Binary:
+            delete static_cast<TPayload<BinaryType>*>(Payload);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* number, bool, inline chars or payload pointer */
+    alignas(8) uint8 Data[MaxInlineLength];
+    uint8 InlineLength;
+    EValueType Type;
 };
+
+static_assert(sizeof(FSignalRValue) == 16, "FSignalRValue is expected to stay 16 bytes");
+
+using FSignalRObject = TSignalRObject<FSignalRValue>;
@@ -1,7 +1,9 @@
 #ifndef JWT_CPP_BASE_H
 #define JWT_CPP_BASE_H
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
@@ -20,6 +22,20 @@ namespace jwt {
 	 * \brief character maps when encoding and decoding
 	 */
 	namespace alphabet {
+		namespace helper {
+			/**
+			 * \brief Builds the character to sextet table of an alphabet, 0xFF marks characters outside of it
+			 */
+			inline std::array<uint8_t, 256> make_reverse(const std::array<char, 64>& alphabet) {
+				std::array<uint8_t, 256> table{};
+				table.fill(0xFF);
+				for (size_t i = 0; i < alphabet.size(); i++) {
+					table[static_cast<unsigned char>(alphabet[i])] = static_cast<uint8_t>(i);
+				}
+				return table;
+			}
+		} // namespace helper
+
 		/**
 		 * \brief valid list of characted when working with [Base64](https://tools.ietf.org/html/rfc3548)
 		 */
@@ -32,6 +48,10 @@ namespace jwt {
 					 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'}};
 				return data;
 			}
+			static const std::array<uint8_t, 256>& rdata() {
+				static const std::array<uint8_t, 256> rdata = helper::make_reverse(data());
+				return rdata;
+			}
 			static const std::string& fill() {
 				static std::string fill{"="};
 				return fill;
@@ -49,6 +69,10 @@ namespace jwt {
 					 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '-', '_'}};
 				return data;
 			}
+			static const std::array<uint8_t, 256>& rdata() {
+				static const std::array<uint8_t, 256> rdata = helper::make_reverse(data());
+				return rdata;
+			}
 			static const std::string& fill() {
 				static std::string fill{"%3d"};
 				return fill;
@@ -67,7 +91,7 @@ namespace jwt {
 		}
 		template<typename T>
 		static std::string decode(const std::string& base) {
-			return decode(base, T::data(), T::fill());
+			return decode(base, T::rdata(), T::fill());
 		}
 		template<typename T>
 		static std::string pad(const std::string& base) {
@@ -81,60 +105,48 @@ namespace jwt {
 	private:
 		static std::string encode(const std::string& bin, const std::array<char, 64>& alphabet,
 								  const std::string& fill) {
-			size_t size = bin.size();
-			std::string res;
+			const size_t size = bin.size();
+			const size_t mod = size % 3;
+			const size_t fast_size = size - mod;
 
-			// clear incomplete bytes
-			size_t fast_size = size - size % 3;
-			for (size_t i = 0; i < fast_size;) {
-				uint32_t octet_a = static_cast<unsigned char>(bin[i++]);
-				uint32_t octet_b = static_cast<unsigned char>(bin[i++]);
-				uint32_t octet_c = static_cast<unsigned char>(bin[i++]);
+			// sized once, every character is written in place
+			std::string res;
+			res.resize(fast_size / 3 * 4 + (mod == 0 ? 0 : mod + 1 + (3 - mod) * fill.size()));
 
-				uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
+			const auto* in = reinterpret_cast<const unsigned char*>(bin.data());
+			char* out = &res[0];
+			for (size_t i = 0; i < fast_size; i += 3) {
+				const uint32_t triple = (uint32_t(in[i]) << 0x10) | (uint32_t(in[i + 1]) << 0x08) | uint32_t(in[i + 2]);
 
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += alphabet[(triple >> 1 * 6) & 0x3F];
-				res += alphabet[(triple >> 0 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 3 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 2 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 1 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 0 * 6) & 0x3F];
 			}
 
-			if (fast_size == size) return res;
-
-			size_t mod = size % 3;
-
-			uint32_t octet_a = fast_size < size ? static_cast<unsigned char>(bin[fast_size++]) : 0;
-			uint32_t octet_b = fast_size < size ? static_cast<unsigned char>(bin[fast_size++]) : 0;
-			uint32_t octet_c = fast_size < size ? static_cast<unsigned char>(bin[fast_size++]) : 0;
-
-			uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
-
-			switch (mod) {
-			case 1:
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += fill;
-				res += fill;
-				break;
-			case 2:
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += alphabet[(triple >> 1 * 6) & 0x3F];
-				res += fill;
-				break;
-			default: break;
+			if (mod == 0) return res;
+
+			const uint32_t octet_a = in[fast_size];
+			const uint32_t octet_b = mod == 2 ? in[fast_size + 1] : 0;
+			const uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08);
+
+			*out++ = alphabet[(triple >> 3 * 6) & 0x3F];
+			*out++ = alphabet[(triple >> 2 * 6) & 0x3F];
+			if (mod == 2) *out++ = alphabet[(triple >> 1 * 6) & 0x3F];
+			for (size_t i = mod; i < 3; i++) {
+				out = std::copy(fill.begin(), fill.end(), out);
 			}
 
 			return res;
 		}
 
-		static std::string decode(const std::string& base, const std::array<char, 64>& alphabet,
+		static std::string decode(const std::string& base, const std::array<uint8_t, 256>& rdata,
 								  const std::string& fill) {
 			size_t size = base.size();
 
 			size_t fill_cnt = 0;
 			while (size > fill.size()) {
-				if (base.substr(size - fill.size(), fill.size()) == fill) {
+				if (base.compare(size - fill.size(), fill.size(), fill) == 0) {
 					fill_cnt++;
 					size -= fill.size();
 					if (fill_cnt > 2) throw std::runtime_error("Invalid input");
@@ -144,45 +156,53 @@ namespace jwt {
 
 			if ((size + fill_cnt) % 4 != 0) throw std::runtime_error("Invalid input");
 
-			size_t out_size = size / 4 * 3;
+			const size_t fast_size = size - size % 4;
 			std::string res;
-			res.reserve(out_size);
-
-			auto get_sextet = [&](size_t offset) {
-				for (size_t i = 0; i < alphabet.size(); i++) {
-					if (alphabet[i] == base[offset]) return static_cast<uint32_t>(i);
-				}
-				throw std::runtime_error("Invalid input");
-			};
-
-			size_t fast_size = size - size % 4;
-			for (size_t i = 0; i < fast_size;) {
-				uint32_t sextet_a = get_sextet(i++);
-				uint32_t sextet_b = get_sextet(i++);
-				uint32_t sextet_c = get_sextet(i++);
-				uint32_t sextet_d = get_sextet(i++);
-
-				uint32_t triple = (sextet_a << 3 * 6) + (sextet_b << 2 * 6) + (sextet_c << 1 * 6) + (sextet_d << 0 * 6);
-
-				res += static_cast<char>((triple >> 2 * 8) & 0xFFU);
-				res += static_cast<char>((triple >> 1 * 8) & 0xFFU);
-				res += static_cast<char>((triple >> 0 * 8) & 0xFFU);
+			res.resize(fast_size / 4 * 3 + (fill_cnt == 0 ? 0 : 3 - fill_cnt));
+
+			const auto* in = reinterpret_cast<const unsigned char*>(base.data());
+			char* out = &res[0];
+
+			// invalid characters map to 0xFF, sextets are or-ed together and checked once per block
+			uint32_t invalid = 0;
+			size_t i = 0;
+			for (; i + 8 <= fast_size; i += 8) {
+				const uint32_t a0 = rdata[in[i]], b0 = rdata[in[i + 1]], c0 = rdata[in[i + 2]], d0 = rdata[in[i + 3]];
+				const uint32_t a1 = rdata[in[i + 4]], b1 = rdata[in[i + 5]], c1 = rdata[in[i + 6]], d1 = rdata[in[i + 7]];
+				invalid |= a0 | b0 | c0 | d0 | a1 | b1 | c1 | d1;
+
+				const uint32_t triple0 = (a0 << 3 * 6) | (b0 << 2 * 6) | (c0 << 1 * 6) | d0;
+				const uint32_t triple1 = (a1 << 3 * 6) | (b1 << 2 * 6) | (c1 << 1 * 6) | d1;
+				out[0] = static_cast<char>((triple0 >> 2 * 8) & 0xFFU);
+				out[1] = static_cast<char>((triple0 >> 1 * 8) & 0xFFU);
+				out[2] = static_cast<char>((triple0 >> 0 * 8) & 0xFFU);
+				out[3] = static_cast<char>((triple1 >> 2 * 8) & 0xFFU);
+				out[4] = static_cast<char>((triple1 >> 1 * 8) & 0xFFU);
+				out[5] = static_cast<char>((triple1 >> 0 * 8) & 0xFFU);
+				out += 6;
+			}
+			for (; i < fast_size; i += 4) {
+				const uint32_t a = rdata[in[i]], b = rdata[in[i + 1]], c = rdata[in[i + 2]], d = rdata[in[i + 3]];
+				invalid |= a | b | c | d;
+
+				const uint32_t triple = (a << 3 * 6) | (b << 2 * 6) | (c << 1 * 6) | d;
+				*out++ = static_cast<char>((triple >> 2 * 8) & 0xFFU);
+				*out++ = static_cast<char>((triple >> 1 * 8) & 0xFFU);
+				*out++ = static_cast<char>((triple >> 0 * 8) & 0xFFU);
 			}
 
-			if (fill_cnt == 0) return res;
-
-			uint32_t triple = (get_sextet(fast_size) << 3 * 6) + (get_sextet(fast_size + 1) << 2 * 6);
+			if (fill_cnt != 0) {
+				const uint32_t a = rdata[in[fast_size]], b = rdata[in[fast_size + 1]];
+				const uint32_t c = fill_cnt == 1 ? rdata[in[fast_size + 2]] : 0;
+				invalid |= a | b | c;
 
-			switch (fill_cnt) {
-			case 1:
-				triple |= (get_sextet(fast_size + 2) << 1 * 6);
-				res += static_cast<char>((triple >> 2 * 8) & 0xFFU);
-				res += static_cast<char>((triple >> 1 * 8) & 0xFFU);
-				break;
-			case 2: res += static_cast<char>((triple >> 2 * 8) & 0xFFU); break;
-			default: break;
+				const uint32_t triple = (a << 3 * 6) | (b << 2 * 6) | (c << 1 * 6);
+				*out++ = static_cast<char>((triple >> 2 * 8) & 0xFFU);
+				if (fill_cnt == 1) *out++ = static_cast<char>((triple >> 1 * 8) & 0xFFU);
 			}
 
+			if (invalid & 0x80) throw std::runtime_error("Invalid input");
+
 			return res;
 		}
 
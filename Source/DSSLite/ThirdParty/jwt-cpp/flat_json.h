@@ -0,0 +1,498 @@
+#ifndef JWT_CPP_FLAT_JSON_H
+#define JWT_CPP_FLAT_JSON_H
+
+#include "jwt.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace jwt {
+	/**
+	 * \brief Allocation light JSON representation for jwt-cpp
+	 *
+	 * Objects are one sorted vector of key/value pairs instead of a std::map node per member, scalars are stored
+	 * inline and short strings stay in the std::string small buffer. Parsing and serialization follow picojson
+	 * (PICOJSON_USE_INT64): integers that fit int64_t are integers, duplicate keys keep the last value, objects
+	 * serialize in key order with the same escapes, so tokens are byte-identical to the picojson_traits ones.
+	 */
+	namespace flat_json {
+		class value;
+
+		using array = std::vector<value>;
+
+		/**
+		 * String keyed container with the std::map interface jwt-cpp uses, kept sorted by key
+		 */
+		class object {
+		public:
+			using key_type = std::string;
+			using mapped_type = value;
+			using value_type = std::pair<std::string, value>;
+			using container_type = std::vector<value_type>;
+			using iterator = container_type::iterator;
+			using const_iterator = container_type::const_iterator;
+
+			iterator begin() { return items.begin(); }
+			iterator end() { return items.end(); }
+			const_iterator begin() const { return items.begin(); }
+			const_iterator end() const { return items.end(); }
+			size_t size() const noexcept { return items.size(); }
+			bool empty() const noexcept { return items.empty(); }
+
+			iterator find(const std::string& key);
+			const_iterator find(const std::string& key) const;
+			size_t count(const std::string& key) const;
+			value& operator[](const std::string& key);
+			value& at(const std::string& key);
+			const value& at(const std::string& key) const;
+
+		private:
+			friend class parser;
+
+			const_iterator lower_bound(const std::string& key) const;
+
+			/// Restores key order after members were appended unsorted, the last of equal keys wins
+			void sort_unique();
+
+			container_type items;
+		};
+
+		class value {
+		public:
+			enum class kind : uint8_t { null, boolean, integer, number, string, array, object };
+
+			value() noexcept : k(kind::null) { scalar.i = 0; }
+			explicit value(bool b) noexcept : k(kind::boolean) { scalar.b = b; }
+			explicit value(int64_t i) noexcept : k(kind::integer) { scalar.i = i; }
+			explicit value(double d) : k(kind::number) {
+				if (std::isnan(d) || std::isinf(d)) throw std::overflow_error("");
+				scalar.d = d;
+			}
+			explicit value(std::string s) : k(kind::string), str(std::move(s)) { scalar.i = 0; }
+			explicit value(const char* s) : k(kind::string), str(s) { scalar.i = 0; }
+			explicit value(flat_json::array a) : k(kind::array), arr(std::move(a)) { scalar.i = 0; }
+			explicit value(flat_json::object o) : k(kind::object), obj(std::move(o)) { scalar.i = 0; }
+
+			kind get_kind() const noexcept { return k; }
+
+			bool as_bool() const { return check(kind::boolean), scalar.b; }
+			int64_t as_int() const { return check(kind::integer), scalar.i; }
+			/// Integers read as numbers too, like picojson
+			double as_number() const {
+				if (k == kind::integer) return static_cast<double>(scalar.i);
+				return check(kind::number), scalar.d;
+			}
+			const std::string& as_string() const { return check(kind::string), str; }
+			const flat_json::array& as_array() const { return check(kind::array), arr; }
+			const flat_json::object& as_object() const { return check(kind::object), obj; }
+
+			std::string serialize() const {
+				std::string out;
+				serialize(out);
+				return out;
+			}
+			void serialize(std::string& out) const;
+
+		private:
+			friend class parser;
+
+			void check(kind expected) const {
+				if (k != expected) throw std::bad_cast();
+			}
+
+			static void serialize_str(const std::string& s, std::string& out);
+
+			kind k;
+			union {
+				bool b;
+				int64_t i;
+				double d;
+			} scalar;
+			std::string str;
+			flat_json::array arr;
+			flat_json::object obj;
+		};
+
+		inline object::const_iterator object::lower_bound(const std::string& key) const {
+			return std::lower_bound(items.begin(), items.end(), key,
+									[](const value_type& item, const std::string& k) { return item.first < k; });
+		}
+
+		inline object::const_iterator object::find(const std::string& key) const {
+			auto it = lower_bound(key);
+			return it != items.end() && it->first == key ? it : items.end();
+		}
+
+		inline object::iterator object::find(const std::string& key) {
+			return items.begin() + (static_cast<const object*>(this)->find(key) - items.cbegin());
+		}
+
+		inline size_t object::count(const std::string& key) const { return find(key) != end() ? 1 : 0; }
+
+		inline value& object::operator[](const std::string& key) {
+			auto it = items.begin() + (lower_bound(key) - items.cbegin());
+			if (it == items.end() || it->first != key) it = items.emplace(it, key, value());
+			return it->second;
+		}
+
+		inline value& object::at(const std::string& key) {
+			auto it = find(key);
+			if (it == items.end()) throw std::out_of_range("key not found");
+			return it->second;
+		}
+
+		inline const value& object::at(const std::string& key) const {
+			auto it = find(key);
+			if (it == items.end()) throw std::out_of_range("key not found");
+			return it->second;
+		}
+
+		inline void object::sort_unique() {
+			std::stable_sort(items.begin(), items.end(),
+							 [](const value_type& a, const value_type& b) { return a.first < b.first; });
+			auto out = items.begin();
+			for (auto it = items.begin(); it != items.end(); ++it) {
+				if (out != items.begin() && (out - 1)->first == it->first) {
+					(out - 1)->second = std::move(it->second);
+				} else {
+					if (out != it) *out = std::move(*it);
+					++out;
+				}
+			}
+			items.erase(out, items.end());
+		}
+
+		inline void value::serialize_str(const std::string& s, std::string& out) {
+			out.push_back('"');
+			for (char c : s) {
+				switch (c) {
+				case '"': out.append("\\\"", 2); break;
+				case '\\': out.append("\\\\", 2); break;
+				case '/': out.append("\\/", 2); break;
+				case '\b': out.append("\\b", 2); break;
+				case '\f': out.append("\\f", 2); break;
+				case '\n': out.append("\\n", 2); break;
+				case '\r': out.append("\\r", 2); break;
+				case '\t': out.append("\\t", 2); break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+						char buf[7];
+						snprintf(buf, sizeof(buf), "\\u%04x", c & 0xff);
+						out.append(buf, 6);
+					} else {
+						out.push_back(c);
+					}
+					break;
+				}
+			}
+			out.push_back('"');
+		}
+
+		inline void value::serialize(std::string& out) const {
+			switch (k) {
+			case kind::null: out.append("null", 4); break;
+			case kind::boolean: scalar.b ? out.append("true", 4) : out.append("false", 5); break;
+			case kind::integer: {
+				char buf[sizeof("-9223372036854775808")];
+				out.append(buf, snprintf(buf, sizeof(buf), "%" PRId64, scalar.i));
+				break;
+			}
+			case kind::number: {
+				char buf[256];
+				double tmp;
+				out.append(buf, snprintf(buf, sizeof(buf),
+										 std::fabs(scalar.d) < (1ULL << 53) && std::modf(scalar.d, &tmp) == 0 ? "%.f" : "%.17g",
+										 scalar.d));
+				break;
+			}
+			case kind::string: serialize_str(str, out); break;
+			case kind::array:
+				out.push_back('[');
+				for (size_t i = 0; i < arr.size(); ++i) {
+					if (i != 0) out.push_back(',');
+					arr[i].serialize(out);
+				}
+				out.push_back(']');
+				break;
+			case kind::object:
+				out.push_back('{');
+				for (auto it = obj.begin(); it != obj.end(); ++it) {
+					if (it != obj.begin()) out.push_back(',');
+					serialize_str(it->first, out);
+					out.push_back(':');
+					it->second.serialize(out);
+				}
+				out.push_back('}');
+				break;
+			}
+		}
+
+		/**
+		 * Single pass parser over a contiguous buffer, accepts what picojson::parse accepts apart from trailing
+		 * garbage after the document
+		 */
+		class parser {
+		public:
+			parser(const char* begin, const char* end) : cur(begin), end(end) {}
+
+			bool parse(value& out) {
+				if (!parse_value(out, max_depth)) return false;
+				skip_ws();
+				return cur == end;
+			}
+
+		private:
+			/// Same nesting limit as picojson
+			static constexpr int max_depth = 100;
+
+			void skip_ws() {
+				while (cur != end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r'))
+					++cur;
+			}
+
+			bool expect(char c) {
+				skip_ws();
+				if (cur == end || *cur != c) return false;
+				++cur;
+				return true;
+			}
+
+			bool match(const char* literal, size_t length) {
+				if (static_cast<size_t>(end - cur) < length || std::memcmp(cur, literal, length) != 0) return false;
+				cur += length;
+				return true;
+			}
+
+			/// out is a default constructed (null) value
+			bool parse_value(value& out, int depth) {
+				skip_ws();
+				if (cur == end) return false;
+				switch (*cur) {
+				case 'n': return match("null", 4);
+				case 't': out.k = value::kind::boolean, out.scalar.b = true; return match("true", 4);
+				case 'f': out.k = value::kind::boolean, out.scalar.b = false; return match("false", 5);
+				case '"':
+					++cur;
+					out.k = value::kind::string;
+					return parse_string(out.str);
+				case '[': {
+					if (depth == 0) return false;
+					++cur;
+					out.k = value::kind::array;
+					if (expect(']')) return true;
+					do {
+						out.arr.emplace_back();
+						if (!parse_value(out.arr.back(), depth - 1)) return false;
+					} while (expect(','));
+					return expect(']');
+				}
+				case '{': {
+					if (depth == 0) return false;
+					++cur;
+					out.k = value::kind::object;
+					if (expect('}')) return true;
+					auto& items = out.obj.items;
+					// claim sets are small, one allocation covers most of them
+					items.reserve(8);
+					bool sorted = true;
+					do {
+						items.emplace_back();
+						auto& item = items.back();
+						if (!expect('"') || !parse_string(item.first) || !expect(':')) return false;
+						if (!parse_value(item.second, depth - 1)) return false;
+						// builders write keys in order, only sort what arrives out of order
+						if (items.size() > 1 && !(items[items.size() - 2].first < item.first)) sorted = false;
+					} while (expect(','));
+					if (!sorted) out.obj.sort_unique();
+					return expect('}');
+				}
+				default:
+					if ((*cur >= '0' && *cur <= '9') || *cur == '-') return parse_number(out);
+					return false;
+				}
+			}
+
+			bool parse_string(std::string& out) {
+				while (true) {
+					// copy runs of plain characters at once
+					const char* run = cur;
+					while (cur != end && *cur != '"' && *cur != '\\' && static_cast<unsigned char>(*cur) >= ' ')
+						++cur;
+					out.append(run, cur - run);
+					if (cur == end) return false;
+					const char c = *cur++;
+					if (c == '"') return true;
+					if (c != '\\') return false;
+					if (cur == end) return false;
+					switch (*cur++) {
+					case '"': out.push_back('"'); break;
+					case '\\': out.push_back('\\'); break;
+					case '/': out.push_back('/'); break;
+					case 'b': out.push_back('\b'); break;
+					case 'f': out.push_back('\f'); break;
+					case 'n': out.push_back('\n'); break;
+					case 'r': out.push_back('\r'); break;
+					case 't': out.push_back('\t'); break;
+					case 'u':
+						if (!parse_codepoint(out)) return false;
+						break;
+					default: return false;
+					}
+				}
+			}
+
+			int parse_quadhex() {
+				if (end - cur < 4) return -1;
+				int uni_ch = 0;
+				for (int i = 0; i < 4; ++i) {
+					int hex = *cur++;
+					if ('0' <= hex && hex <= '9')
+						hex -= '0';
+					else if ('A' <= hex && hex <= 'F')
+						hex -= 'A' - 0xa;
+					else if ('a' <= hex && hex <= 'f')
+						hex -= 'a' - 0xa;
+					else
+						return -1;
+					uni_ch = uni_ch * 16 + hex;
+				}
+				return uni_ch;
+			}
+
+			bool parse_codepoint(std::string& out) {
+				int uni_ch = parse_quadhex();
+				if (uni_ch == -1) return false;
+				if (0xd800 <= uni_ch && uni_ch <= 0xdfff) {
+					// a lone second half is invalid, a first half needs its pair
+					if (0xdc00 <= uni_ch) return false;
+					if (!match("\\u", 2)) return false;
+					const int second = parse_quadhex();
+					if (!(0xdc00 <= second && second <= 0xdfff)) return false;
+					uni_ch = (((uni_ch - 0xd800) << 10) | ((second - 0xdc00) & 0x3ff)) + 0x10000;
+				}
+				if (uni_ch < 0x80) {
+					out.push_back(static_cast<char>(uni_ch));
+				} else {
+					if (uni_ch < 0x800) {
+						out.push_back(static_cast<char>(0xc0 | (uni_ch >> 6)));
+					} else {
+						if (uni_ch < 0x10000) {
+							out.push_back(static_cast<char>(0xe0 | (uni_ch >> 12)));
+						} else {
+							out.push_back(static_cast<char>(0xf0 | (uni_ch >> 18)));
+							out.push_back(static_cast<char>(0x80 | ((uni_ch >> 12) & 0x3f)));
+						}
+						out.push_back(static_cast<char>(0x80 | ((uni_ch >> 6) & 0x3f)));
+					}
+					out.push_back(static_cast<char>(0x80 | (uni_ch & 0x3f)));
+				}
+				return true;
+			}
+
+			bool parse_number(value& out) {
+				const char* start = cur;
+				bool digits_only = true;
+				while (cur != end) {
+					const char c = *cur;
+					if (c >= '0' && c <= '9') {
+					} else if (c == '-' || c == '+' || c == 'e' || c == 'E' || c == '.') {
+						if (!(c == '-' && cur == start)) digits_only = false;
+					} else {
+						break;
+					}
+					++cur;
+				}
+
+				const bool negative = *start == '-';
+				const char* digits = start + (negative ? 1 : 0);
+				// plain integers (exp, iat, nbf) are read without strtoimax
+				if (digits_only && digits != cur && cur - digits <= 18) {
+					int64_t i = 0;
+					for (const char* p = digits; p != cur; ++p)
+						i = i * 10 + (*p - '0');
+					out.k = value::kind::integer;
+					out.scalar.i = negative ? -i : i;
+					return true;
+				}
+
+				const std::string num_str(start, cur);
+				char* endp;
+				errno = 0;
+				const intmax_t ival = strtoimax(num_str.c_str(), &endp, 10);
+				if (errno == 0 && std::numeric_limits<int64_t>::min() <= ival &&
+					ival <= std::numeric_limits<int64_t>::max() && endp == num_str.c_str() + num_str.size()) {
+					out.k = value::kind::integer;
+					out.scalar.i = static_cast<int64_t>(ival);
+					return true;
+				}
+				const double f = strtod(num_str.c_str(), &endp);
+				// out of range literals (1e400) come back as inf, picojson refuses them too
+				if (endp != num_str.c_str() + num_str.size() || !std::isfinite(f)) return false;
+				out.k = value::kind::number;
+				out.scalar.d = f;
+				return true;
+			}
+
+			const char* cur;
+			const char* end;
+		};
+	} // namespace flat_json
+
+	/**
+	 * jwt-cpp traits for flat_json, a drop in replacement for picojson_traits
+	 */
+	struct flat_json_traits {
+		using value_type = flat_json::value;
+		using object_type = flat_json::object;
+		using array_type = flat_json::array;
+		using string_type = std::string;
+		using number_type = double;
+		using integer_type = int64_t;
+		using boolean_type = bool;
+
+		static json::type get_type(const flat_json::value& val) {
+			using json::type;
+			switch (val.get_kind()) {
+			case flat_json::value::kind::boolean: return type::boolean;
+			case flat_json::value::kind::integer: return type::integer;
+			case flat_json::value::kind::number: return type::number;
+			case flat_json::value::kind::string: return type::string;
+			case flat_json::value::kind::array: return type::array;
+			case flat_json::value::kind::object: return type::object;
+			default: throw std::logic_error("invalid type");
+			}
+		}
+
+		static flat_json::object as_object(const flat_json::value& val) { return val.as_object(); }
+
+		static std::string as_string(const flat_json::value& val) { return val.as_string(); }
+
+		static flat_json::array as_array(const flat_json::value& val) { return val.as_array(); }
+
+		static int64_t as_int(const flat_json::value& val) { return val.as_int(); }
+
+		static bool as_bool(const flat_json::value& val) { return val.as_bool(); }
+
+		static double as_number(const flat_json::value& val) { return val.as_number(); }
+
+		static bool parse(flat_json::value& val, const std::string& str) {
+			val = flat_json::value();
+			return flat_json::parser(str.data(), str.data() + str.size()).parse(val);
+		}
+
+		static std::string serialize(const flat_json::value& val) { return val.serialize(); }
+	};
+} // namespace jwt
+
+#endif
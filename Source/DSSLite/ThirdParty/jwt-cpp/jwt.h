@@ -15,6 +15,7 @@
 #define UI UI_ST
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
+#include <openssl/crypto.h>
 #include <openssl/pem.h>
 #include <openssl/ec.h>
 #include <openssl/err.h>
@@ -56,6 +57,13 @@
 #define OPENSSL110
 #endif
 
+// If openssl version 3.0 or newer, HMAC_CTX is deprecated in favour of EVP_MAC
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define OPENSSL30
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
+
 #ifndef JWT_CLAIM_EXPLICIT
 #define JWT_CLAIM_EXPLICIT explicit
 #endif
@@ -693,6 +701,10 @@ namespace jwt {
 		};
 		/**
 		 * \brief Base class for HMAC family of algorithms
+		 *
+		 * The key is hashed into the inner and outer states once, in the constructor. Every signature clones
+		 * that keyed context (into a thread local one before OpenSSL 3, with EVP_MAC_CTX_dup after), instances
+		 * can be shared between threads.
 		 */
 		struct hmacsha {
 			/**
@@ -702,7 +714,23 @@ namespace jwt {
 			 * \param name Name of the algorithm
 			 */
 			hmacsha(std::string key, const EVP_MD* (*md)(), std::string name)
-				: secret(std::move(key)), md(md), alg_name(std::move(name)) {}
+				: secret(std::move(key)), md(md), alg_name(std::move(name)) {
+#if defined(OPENSSL30)
+				std::unique_ptr<EVP_MAC, decltype(&EVP_MAC_free)> mac(EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr),
+																	 EVP_MAC_free);
+				std::shared_ptr<EVP_MAC_CTX> ctx(mac ? EVP_MAC_CTX_new(mac.get()) : nullptr, EVP_MAC_CTX_free);
+				OSSL_PARAM params[] = {OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+																		 const_cast<char*>(EVP_MD_get0_name(md())), 0),
+									   OSSL_PARAM_construct_end()};
+				if (ctx && EVP_MAC_init(ctx.get(), reinterpret_cast<const unsigned char*>(secret.data()), secret.size(),
+										params) == 1)
+					keyed = std::move(ctx);
+#elif !defined(OPENSSL10)
+				std::shared_ptr<HMAC_CTX> ctx(HMAC_CTX_new(), HMAC_CTX_free);
+				if (ctx && HMAC_Init_ex(ctx.get(), secret.data(), static_cast<int>(secret.size()), md(), nullptr) == 1)
+					keyed = std::move(ctx);
+#endif
+			}
 			/**
 			 * Sign jwt data
 			 * \param data The data to sign
@@ -711,17 +739,44 @@ namespace jwt {
 			 */
 			std::string sign(const std::string& data, std::error_code& ec) const {
 				ec.clear();
-				std::string res(static_cast<size_t>(EVP_MAX_MD_SIZE), '\0');
-				auto len = static_cast<unsigned int>(res.size());
-				if (HMAC(md(), secret.data(), static_cast<int>(secret.size()),
-						 reinterpret_cast<const unsigned char*>(data.data()), static_cast<int>(data.size()),
-						 (unsigned char*)res.data(), // NOLINT(google-readability-casting) requires `const_cast`
-						 &len) == nullptr) {
+				unsigned char res[EVP_MAX_MD_SIZE];
+				unsigned int len = 0;
+				if (!sign(data.data(), data.size(), res, len)) {
 					ec = error::signature_generation_error::hmac_failed;
 					return {};
 				}
-				res.resize(len);
-				return res;
+				return std::string(reinterpret_cast<const char*>(res), len);
+			}
+			/**
+			 * Sign jwt data into a caller provided buffer, without allocating
+			 * \param data The data to sign
+			 * \param size Size of data
+			 * \param out Receives the signature, at least EVP_MAX_MD_SIZE bytes
+			 * \param len Receives the signature length
+			 * \return false if signing failed
+			 */
+			bool sign(const char* data, size_t size, unsigned char* out, unsigned int& len) const {
+#if defined(OPENSSL30)
+				if (keyed) {
+					std::unique_ptr<EVP_MAC_CTX, decltype(&EVP_MAC_CTX_free)> ctx(EVP_MAC_CTX_dup(keyed.get()),
+																				   EVP_MAC_CTX_free);
+					size_t out_len = 0;
+					if (!ctx || EVP_MAC_update(ctx.get(), reinterpret_cast<const unsigned char*>(data), size) != 1 ||
+						EVP_MAC_final(ctx.get(), out, &out_len, EVP_MAX_MD_SIZE) != 1)
+						return false;
+					len = static_cast<unsigned int>(out_len);
+					return true;
+				}
+#elif !defined(OPENSSL10)
+				HMAC_CTX* ctx = thread_context();
+				if (keyed && ctx != nullptr) {
+					return HMAC_CTX_copy(ctx, keyed.get()) == 1 &&
+						   HMAC_Update(ctx, reinterpret_cast<const unsigned char*>(data), size) == 1 &&
+						   HMAC_Final(ctx, out, &len) == 1;
+				}
+#endif
+				return HMAC(md(), secret.data(), static_cast<int>(secret.size()),
+							reinterpret_cast<const unsigned char*>(data), size, out, &len) != nullptr;
 			}
 			/**
 			 * Check if signature is valid
@@ -731,14 +786,14 @@ namespace jwt {
 			 */
 			void verifyToken(const std::string& data, const std::string& signature, std::error_code& ec) const {
 				ec.clear();
-				auto res = sign(data, ec);
-				if (ec) return;
+				unsigned char res[EVP_MAX_MD_SIZE];
+				unsigned int len = 0;
+				if (!sign(data.data(), data.size(), res, len)) {
+					ec = error::signature_generation_error::hmac_failed;
+					return;
+				}
 
-				bool matched = true;
-				for (size_t i = 0; i < std::min<size_t>(res.size(), signature.size()); i++)
-					if (res[i] != signature[i]) matched = false;
-				if (res.size() != signature.size()) matched = false;
-				if (!matched) {
+				if (len != signature.size() || CRYPTO_memcmp(res, signature.data(), len) != 0) {
 					ec = error::signature_verification_error::invalid_signature;
 					return;
 				}
@@ -750,6 +805,23 @@ namespace jwt {
 			std::string name() const { return alg_name; }
 
 		private:
+#if defined(OPENSSL30)
+			/// context keyed once with the secret, only ever read after construction
+			std::shared_ptr<EVP_MAC_CTX> keyed;
+#elif !defined(OPENSSL10)
+			/// per thread scratch context the keyed state is cloned into, allocated once per thread
+			static HMAC_CTX* thread_context() {
+				struct holder {
+					HMAC_CTX* ctx = HMAC_CTX_new();
+					~holder() { HMAC_CTX_free(ctx); }
+				};
+				static thread_local holder scratch;
+				return scratch.ctx;
+			}
+
+			/// context keyed once with the secret, only ever read after construction
+			std::shared_ptr<HMAC_CTX> keyed;
+#endif
 			/// HMAC secrect
 			const std::string secret;
 			/// HMAC hash generator